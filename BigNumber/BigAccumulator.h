@@ -0,0 +1,184 @@
+/* BigAccumulator.h
+**
+** Running sum of many big integers, for summing long columns of numbers.
+**
+** Decimal input is never converted to binary per number: its 9-digit chunks are added as they are into
+** 64-bit base-10^9 accumulators, and BigInt input is added limb by limb into 64-bit base-2^32 accumulators.
+** The carries are left in the upper bits and only propagated every 2^30 additions or when the result is asked,
+** so adding a number is one pass over its digits with no allocation once the accumulators are long enough.
+** Negative numbers go to separate accumulators which are subtracted at the end.
+**
+** compiled and tested with g++ 12.2.0
+**
+** MIT License
+** Copyright (c) 2017 636F57@GitHub
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE
+*/
+
+#ifndef BIGACCUMULATOR_H
+#define BIGACCUMULATOR_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <istream>
+#include <stdexcept>
+#include "BigInt.h"
+#include "BigConvert.h"
+#include "BigScratch.h"
+
+class BigAccumulator
+{
+	typedef BigKernels::limb_t limb_t;
+
+private:
+	static const size_t NORMALIZE_INTERVAL = (size_t)1 << 30;  // each addition adds less than 2^32 to a 64-bit slot
+
+	std::vector<uint64_t> vDecPos, vDecNeg;  // sums of base-10^9 chunks, little-endian, carries pending
+	std::vector<uint64_t> vBinPos, vBinNeg;  // sums of 32-bit limbs, little-endian, carries pending
+	size_t nPending = 0;  // additions since the last normalization
+	size_t nCount = 0;
+
+	// propagate the pending carries so that every slot is below nBase again
+	static void normalize(std::vector<uint64_t>& vAcc, uint64_t nBase)
+	{
+		uint64_t uCarry = 0;
+		for (size_t i=0; i<vAcc.size(); i++)
+		{
+			uint64_t uTmp = vAcc[i] + uCarry;
+			vAcc[i] = uTmp % nBase;
+			uCarry = uTmp / nBase;
+		}
+		while (uCarry > 0)
+		{
+			vAcc.push_back(uCarry % nBase);
+			uCarry /= nBase;
+		}
+	}
+
+	void countAddition()
+	{
+		nCount++;
+		if (++nPending >= NORMALIZE_INTERVAL)
+		{
+			normalize(vDecPos, BigConvert::CHUNK_BASE);
+			normalize(vDecNeg, BigConvert::CHUNK_BASE);
+			normalize(vBinPos, (uint64_t)1 << BigKernels::LIMB_BITS);
+			normalize(vBinNeg, (uint64_t)1 << BigKernels::LIMB_BITS);
+			nPending = 0;
+		}
+	}
+
+	// magnitude of the normalized decimal and binary sums
+	static BigInt total(std::vector<uint64_t> vDec, std::vector<uint64_t> vBin)
+	{
+		normalize(vDec, BigConvert::CHUNK_BASE);
+		normalize(vBin, (uint64_t)1 << BigKernels::LIMB_BITS);
+		std::vector<limb_t> vChunks(vDec.begin(), vDec.end());
+		std::vector<limb_t> vLimbs(vBin.begin(), vBin.end());
+		return BigInt::fromLimbs(BigConvert::fromChunks(vChunks.data(), vChunks.size())) + BigInt::fromLimbs(vLimbs);
+	}
+
+public:
+	BigAccumulator(){}
+	~BigAccumulator(){}
+
+	// add a base-10 integer with an optional leading '-' or '+'. throw std::invalid_argument on other characters.
+	void add(const char* pNum, size_t nLen)
+	{
+		bool bNeg = false;
+		if ((nLen > 0) && ((pNum[0] == '-') || (pNum[0] == '+')))
+		{
+			bNeg = (pNum[0] == '-');
+			pNum++;
+			nLen--;
+		}
+		if (nLen == 0)
+			throw std::invalid_argument("BigAccumulator: no digits");
+
+		// all the chunks are parsed before any is added, so that an invalid number leaves the sum as it was
+		size_t nChunks = (nLen + BigConvert::CHUNK_DIGITS - 1) / BigConvert::CHUNK_DIGITS;
+		BigScratch::Frame frame;
+		limb_t* pChunks = frame.allocate<limb_t>(nChunks);
+		size_t nEnd = nLen;
+		for (size_t i=0; i<nChunks; i++)
+		{
+			size_t nChunkLen = std::min<size_t>(BigConvert::CHUNK_DIGITS, nEnd);
+			pChunks[i] = BigConvert::parseChunk(pNum + nEnd - nChunkLen, nChunkLen);
+			nEnd -= nChunkLen;
+		}
+
+		std::vector<uint64_t>& vAcc = bNeg ? vDecNeg : vDecPos;
+		if (vAcc.size() < nChunks)
+			vAcc.resize(nChunks, 0);
+		for (size_t i=0; i<nChunks; i++)
+			vAcc[i] += pChunks[i];
+		countAddition();
+	}
+
+	void add(const std::string& strNum)
+	{
+		add(strNum.data(), strNum.size());
+	}
+
+	void add(const BigInt& biNum)
+	{
+		const std::vector<limb_t>& vLimbs = biNum.limbs();
+		std::vector<uint64_t>& vAcc = biNum.isNegative() ? vBinNeg : vBinPos;
+		if (vAcc.size() < vLimbs.size())
+			vAcc.resize(vLimbs.size(), 0);
+		for (size_t i=0; i<vLimbs.size(); i++)
+			vAcc[i] += vLimbs[i];
+		countAddition();
+	}
+
+	// add all the whitespace separated numbers until the end of the stream. return how many were added.
+	// throw std::invalid_argument naming the first token which is not a number, after adding those before it.
+	size_t addFromStream(std::istream& is)
+	{
+		size_t nAdded = 0;
+		std::string strToken;
+		while (is >> strToken)
+		{
+			try
+			{
+				add(strToken);
+			}
+			catch (const std::invalid_argument&)
+			{
+				throw std::invalid_argument("BigAccumulator: invalid number \"" + strToken + "\"");
+			}
+			nAdded++;
+		}
+		return nAdded;
+	}
+
+	// the sum of all the numbers added so far
+	BigInt result() const
+	{
+		return total(vDecPos, vBinPos) - total(vDecNeg, vBinNeg);
+	}
+
+	std::string toString() const
+	{
+		return result().toString();
+	}
+
+	// number of additions so far
+	size_t count() const
+	{
+		return nCount;
+	}
+
+	void clear()
+	{
+		vDecPos.clear();
+		vDecNeg.clear();
+		vBinPos.clear();
+		vBinNeg.clear();
+		nPending = 0;
+		nCount = 0;
+	}
+};
+
+#endif
@@ -0,0 +1,285 @@
+/* BigConvert.h
+**
+** Conversion between base-10 digit strings and the 32-bit binary limbs of BigKernels.h, used by BigInt.
+**
+** Both directions are divide-and-conquer on chunks of 9 decimal digits (values below 10^9):
+**  fromDecimal: value = high * 10^(9*2^k) + low, where the halves are converted recursively.
+**  toDecimal  : value = q * 10^(9*2^k) + r by one division, then q and r are converted recursively.
+** The powers 10^(9*2^k) are made by repeated squaring, so all the work goes into the fast multiplication
+** and division of BigKernels. Small pieces use the quadratic method, which is faster there.
+** Digits are parsed 8 at a time in a 64-bit register (SWAR) on little-endian machines, long inputs over threads.
+**
+** compiled and tested with g++ 12.2.0
+**
+** MIT License
+** Copyright (c) 2017 636F57@GitHub
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE
+*/
+
+#ifndef BIGCONVERT_H
+#define BIGCONVERT_H
+
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <exception>
+#include "BigKernels.h"
+#include "BigScratch.h"
+
+class BigConvert
+{
+public:
+	typedef BigKernels::limb_t limb_t;
+
+	static const limb_t CHUNK_BASE = 1000000000;  // the largest power of 10 fitting in a limb
+	static const int CHUNK_DIGITS = 9;
+
+	// convert the digits pDigits[0,nDigits) (no sign) into limbs without leading zero limbs.
+	// throw std::invalid_argument when a non-digit character is found.
+	static std::vector<limb_t> fromDecimal(const char* pDigits, size_t nDigits)
+	{
+		// little-endian array of 9-digit chunks. long inputs are parsed in one block of chunks per thread,
+		// and an exception in a block is passed on after all the blocks are done.
+		size_t nChunks = (nDigits + CHUNK_DIGITS - 1) / CHUNK_DIGITS;
+		std::vector<limb_t> vChunks(nChunks);
+		size_t nBlocks = (nChunks >= PARALLEL_CHUNKS) ? BigThreads::count() : 1;
+		size_t nBlockLen = (nChunks + nBlocks - 1) / nBlocks;
+		std::vector<std::exception_ptr> vErrors(nBlocks);
+		BigThreads::parallelFor(nBlocks, [&](size_t t) {
+			try
+			{
+				for (size_t i=t*nBlockLen; i<std::min(nChunks, (t+1)*nBlockLen); i++)
+				{
+					size_t nEnd = nDigits - i*CHUNK_DIGITS;
+					size_t nLen = std::min<size_t>(CHUNK_DIGITS, nEnd);
+					vChunks[i] = parseChunk(pDigits + nEnd - nLen, nLen);
+				}
+			}
+			catch (...)
+			{
+				vErrors[t] = std::current_exception();
+			}
+		});
+		for (size_t t=0; t<nBlocks; t++)
+		{
+			if (vErrors[t])
+				std::rethrow_exception(vErrors[t]);
+		}
+
+		return fromChunks(vChunks.data(), nChunks);
+	}
+
+	// return the base-10 digits of a[0,n) (no sign, no leading zeros, "0" for zero)
+	static std::string toDecimal(const limb_t* a, size_t n)
+	{
+		std::vector<limb_t> vChunks = toChunks(a, n);
+		std::string strResult = std::to_string(vChunks.back());
+		size_t nPos = strResult.size();
+		strResult.resize(nPos + (vChunks.size()-1)*CHUNK_DIGITS);
+		formatChunks(&strResult[nPos], vChunks.data(), vChunks.size()-1);
+		return strResult;
+	}
+
+	// little-endian 9-digit chunks of a[0,n) without leading zero chunks (one zero chunk for zero).
+	// 4 bytes per 9 digits, so a number can be written out in pieces without holding all of its text.
+	static std::vector<limb_t> toChunks(const limb_t* a, size_t n)
+	{
+		n = BigKernels::normSize(a, n);
+		if (n == 0)
+			return std::vector<limb_t>(1, 0);
+
+		// a number of chunks which surely holds the value. 32*log10(2) < 9.64 digits per limb.
+		size_t nDigitsMax = (n*964 + 99) / 100;
+		size_t nChunks = (nDigitsMax + CHUNK_DIGITS - 1) / CHUNK_DIGITS;
+
+		std::vector<std::vector<limb_t>> vPowers;
+		makePowers(vPowers, nChunks);
+		std::vector<limb_t> vChunks(nChunks, 0);
+		limbsToChunks(vChunks.data(), nChunks, a, n, vPowers);
+
+		size_t nTop = nChunks;
+		while ((nTop > 1) && (vChunks[nTop-1] == 0))
+			nTop--;
+		vChunks.resize(nTop);
+		return vChunks;
+	}
+
+	// write the little-endian chunks c[0,n) from the most significant one as exactly 9*n digits to p
+	static void formatChunks(char* p, const limb_t* c, size_t n)
+	{
+		for (size_t i=n; i>0; i--)
+		{
+			limb_t nValue = c[i-1];
+			for (int j=CHUNK_DIGITS-1; j>=0; j--)
+			{
+				p[j] = '0' + nValue % 10;
+				nValue /= 10;
+			}
+			p += CHUNK_DIGITS;
+		}
+	}
+
+	// value of 1 to 9 digits. throw std::invalid_argument on a non-digit character
+	static limb_t parseChunk(const char* p, size_t nLen)
+	{
+		limb_t nValue = 0;
+		size_t i = 0;
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+		if (nLen >= 8)
+		{
+			nValue = parse8(p);
+			i = 8;
+		}
+#endif
+		for (; i<nLen; i++)
+		{
+			if ((p[i] < '0') || (p[i] > '9'))
+				throw std::invalid_argument("BigConvert: invalid character '" + std::string(1, p[i]) + "'");
+			nValue = nValue*10 + (p[i] - '0');
+		}
+		return nValue;
+	}
+
+	// limbs without leading zero limbs of the little-endian 9-digit chunks c[0,n), each below CHUNK_BASE
+	static std::vector<limb_t> fromChunks(const limb_t* c, size_t n)
+	{
+		std::vector<std::vector<limb_t>> vPowers;
+		makePowers(vPowers, n);
+		std::vector<limb_t> vResult(chunksToLimbsSize(n, vPowers));
+		chunksToLimbs(vResult.data(), c, n, vPowers);
+		vResult.resize(BigKernels::normSize(vResult.data(), vResult.size()));
+		return vResult;
+	}
+
+private:
+	static const size_t BASECASE_CHUNKS = 64;  // quadratic conversion below this many chunks
+	static const size_t BASECASE_LIMBS = 64;
+	static const size_t PARALLEL_CHUNKS = (size_t)1 << 16;  // parse the digits over threads from this many chunks
+
+	// value of exactly 8 digits by SWAR: the byte lanes are combined pairwise, 2 -> 4 -> 8 digits
+	static limb_t parse8(const char* p)
+	{
+		uint64_t uVal;
+		std::memcpy(&uVal, p, 8);
+		if ((((uVal + 0x4646464646464646ULL) | (uVal - 0x3030303030303030ULL)) & 0x8080808080808080ULL) != 0)
+			throw std::invalid_argument("BigConvert: invalid character in \"" + std::string(p, 8) + "\"");
+		uVal = ((uVal & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+		uVal = ((uVal & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+		return (limb_t)(((uVal & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32);
+	}
+
+	// vPowers[k] = 10^(9*2^k) for all 2^k < nChunks
+	static void makePowers(std::vector<std::vector<limb_t>>& vPowers, size_t nChunks)
+	{
+		vPowers.clear();
+		vPowers.push_back(std::vector<limb_t>(1, (limb_t)CHUNK_BASE));
+		for (size_t nSize=2; nSize<nChunks; nSize<<=1)
+		{
+			const std::vector<limb_t>& vPrev = vPowers.back();
+			std::vector<limb_t> vNext(2*vPrev.size());
+			BigKernels::mul(vNext.data(), vPrev.data(), vPrev.size(), vPrev.data(), vPrev.size());
+			vNext.resize(BigKernels::normSize(vNext.data(), vNext.size()));
+			vPowers.push_back(vNext);
+		}
+	}
+
+	// index k of the power 10^(9*2^k) where n > BASECASE_CHUNKS chunks are split: the largest power of 2 below n
+	static size_t splitIndex(size_t n)
+	{
+		size_t k = 0;
+		while (((size_t)2 << k) < n)
+			k++;
+		return k;
+	}
+
+	// number of limbs written by chunksToLimbs for n chunks
+	static size_t chunksToLimbsSize(size_t n, const std::vector<std::vector<limb_t>>& vPowers)
+	{
+		if (n <= BASECASE_CHUNKS)
+			return n;
+		size_t k = splitIndex(n);
+		return chunksToLimbsSize(n - ((size_t)1 << k), vPowers) + vPowers[k].size() + 1;
+	}
+
+	// r[0,chunksToLimbsSize(n)) = limbs of the little-endian chunks c[0,n), with leading zero limbs
+	static void chunksToLimbs(limb_t* r, const limb_t* c, size_t n, const std::vector<std::vector<limb_t>>& vPowers)
+	{
+		size_t nSize = chunksToLimbsSize(n, vPowers);
+		if (n <= BASECASE_CHUNKS)
+		{
+			std::fill(r, r+nSize, 0);
+			size_t nLen = 0;
+			for (size_t i=n; i>0; i--)
+			{
+				limb_t nCarry = BigKernels::mulSmall(r, r, nLen, CHUNK_BASE, c[i-1]);
+				if (nCarry > 0)
+					r[nLen++] = nCarry;
+			}
+			return;
+		}
+
+		size_t k = splitIndex(n);
+		size_t nLow = (size_t)1 << k;
+		size_t nLowSize = chunksToLimbsSize(nLow, vPowers);
+		size_t nHighSize = chunksToLimbsSize(n-nLow, vPowers);
+		BigScratch::Frame frame;
+		limb_t* pLow = frame.allocate<limb_t>(nLowSize);
+		limb_t* pHigh = frame.allocate<limb_t>(nHighSize);
+		chunksToLimbs(pLow, c, nLow, vPowers);
+		chunksToLimbs(pHigh, c+nLow, n-nLow, vPowers);
+		size_t nHigh = BigKernels::normSize(pHigh, nHighSize);
+
+		const std::vector<limb_t>& vPow = vPowers[k];
+		BigKernels::mul(r, pHigh, nHigh, vPow.data(), vPow.size());
+		std::fill(r + nHigh + vPow.size(), r + nSize, 0);
+		BigKernels::add(r, r, nSize, pLow, BigKernels::normSize(pLow, nLowSize));
+	}
+
+	// c[0,nChunks) = the little-endian chunks of a[0,n), where a < 10^(9*nChunks).
+	// the largest power is only used at the top and is freed as soon as it has been divided by.
+	static void limbsToChunks(limb_t* c, size_t nChunks, const limb_t* a, size_t n, std::vector<std::vector<limb_t>>& vPowers)
+	{
+		n = BigKernels::normSize(a, n);
+		if (n == 0)
+		{
+			std::fill(c, c+nChunks, 0);
+			return;
+		}
+		if ((n <= BASECASE_LIMBS) || (nChunks == 1))
+		{
+			BigScratch::Frame frame;
+			limb_t* pTmp = frame.allocate<limb_t>(n);
+			std::copy(a, a+n, pTmp);
+			for (size_t i=0; i<nChunks; i++)
+			{
+				c[i] = BigKernels::divSmall(pTmp, pTmp, n, CHUNK_BASE);
+				n = BigKernels::normSize(pTmp, n);
+			}
+			return;
+		}
+
+		// a = q * 10^(9*nLow) + r, where nLow is the largest power of 2 below nChunks
+		size_t k = splitIndex(nChunks);
+		size_t nLow = (size_t)1 << k;
+		std::vector<limb_t>& vPow = vPowers[k];
+		size_t nPow = vPow.size();
+		if (BigKernels::cmp(a, n, vPow.data(), nPow) < 0)
+		{
+			limbsToChunks(c, nLow, a, n, vPowers);
+			std::fill(c+nLow, c+nChunks, 0);
+			return;
+		}
+		BigScratch::Frame frame;
+		size_t nQ = n - nPow + 1;
+		limb_t* pQ = frame.allocate<limb_t>(nQ);
+		limb_t* pR = frame.allocate<limb_t>(nPow);
+		BigKernels::divmod(pQ, pR, a, n, vPow.data(), nPow);
+		if (k + 1 == vPowers.size())
+			std::vector<limb_t>().swap(vPow);
+		limbsToChunks(c, nLow, pR, nPow, vPowers);
+		limbsToChunks(c+nLow, nChunks-nLow, pQ, nQ, vPowers);
+	}
+};
+
+#endif
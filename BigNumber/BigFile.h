@@ -0,0 +1,232 @@
+/* BigFile.h
+**
+** Reading and writing big integers of up to several gigabytes directly from and to files.
+**
+** Input files are memory-mapped, so the text is never copied into a std::string: the digits are parsed
+** straight from the mapping into 9-digit chunks (over threads, see BigConvert::fromDecimal) and then converted
+** to limbs. Output is produced from the 9-digit chunks in blocks which are formatted over threads and written
+** one after another, so the full decimal text is never held in memory either.
+** The peak memory stays near the size of the binary representation instead of several times the text size.
+**
+** Two formats are recognized:
+**  decimal: base-10 text with an optional leading '-' or '+', surrounded by optional white space.
+**  binary : the 4 bytes "BIGN", a sign byte '+' or '-', then the magnitude in little-endian bytes.
+**
+** compiled and tested with g++ 12.2.0 (POSIX mmap, compile with -pthread)
+**
+** MIT License
+** Copyright (c) 2017 636F57@GitHub
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE
+*/
+
+#ifndef BIGFILE_H
+#define BIGFILE_H
+
+#include <cstdio>
+#include <cstring>
+#include <cctype>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "BigInt.h"
+#include "BigConvert.h"
+#include "BigScratch.h"
+#include "BigThreads.h"
+
+class BigFile
+{
+	typedef BigKernels::limb_t limb_t;
+
+private:
+	static const size_t WRITE_BLOCK_CHUNKS = (size_t)1 << 20;  // 9 MB of digits per write
+
+	// read-only mapping of a whole file, unmapped on destruction
+	class MappedFile
+	{
+	private:
+		int nFd = -1;
+		const char* pData = nullptr;
+		size_t nSize = 0;
+
+	public:
+		explicit MappedFile(const std::string& strPath)
+		{
+			nFd = open(strPath.c_str(), O_RDONLY);
+			if (nFd < 0)
+				throw std::runtime_error("BigFile: cannot open " + strPath);
+			struct stat st;
+			if (fstat(nFd, &st) != 0)
+			{
+				close(nFd);
+				throw std::runtime_error("BigFile: cannot stat " + strPath);
+			}
+			nSize = (size_t)st.st_size;
+			if (nSize == 0)
+				return;
+			void* pMap = mmap(nullptr, nSize, PROT_READ, MAP_PRIVATE, nFd, 0);
+			if (pMap == MAP_FAILED)
+			{
+				close(nFd);
+				throw std::runtime_error("BigFile: cannot map " + strPath);
+			}
+			madvise(pMap, nSize, MADV_SEQUENTIAL);
+			pData = (const char*)pMap;
+		}
+
+		~MappedFile()
+		{
+			if (pData != nullptr)
+				munmap((void*)pData, nSize);
+			if (nFd >= 0)
+				close(nFd);
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		const char* data() const { return pData; }
+		size_t size() const { return nSize; }
+	};
+
+	static bool isBinary(const char* p, size_t n)
+	{
+		return (n >= 5) && (std::memcmp(p, "BIGN", 4) == 0) && ((p[4] == '+') || (p[4] == '-'));
+	}
+
+	static BigInt parseBinary(const char* p, size_t n)
+	{
+		bool bNeg = (p[4] == '-');
+		p += 5;
+		n -= 5;
+		std::vector<limb_t> vLimbs((n + sizeof(limb_t) - 1) / sizeof(limb_t), 0);
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+		std::memcpy(vLimbs.data(), p, n);
+#else
+		for (size_t i=0; i<n; i++)
+			vLimbs[i / sizeof(limb_t)] |= (limb_t)(unsigned char)p[i] << (8 * (i % sizeof(limb_t)));
+#endif
+		return BigInt::fromLimbs(vLimbs, bNeg);
+	}
+
+	static BigInt parseDecimal(const char* p, size_t n)
+	{
+		while ((n > 0) && std::isspace((unsigned char)p[n-1]))
+			n--;
+		while ((n > 0) && std::isspace((unsigned char)p[0]))
+		{
+			p++;
+			n--;
+		}
+		bool bNeg = false;
+		if ((n > 0) && ((p[0] == '-') || (p[0] == '+')))
+		{
+			bNeg = (p[0] == '-');
+			p++;
+			n--;
+		}
+		if (n == 0)
+			throw std::invalid_argument("BigFile: no digits");
+		return BigInt::fromLimbs(BigConvert::fromDecimal(p, n), bNeg);
+	}
+
+	static std::FILE* openForWrite(const std::string& strPath)
+	{
+		std::FILE* pFile = std::fopen(strPath.c_str(), "wb");
+		if (pFile == nullptr)
+			throw std::runtime_error("BigFile: cannot create " + strPath);
+		return pFile;
+	}
+
+	static void writeBytes(std::FILE* pFile, const void* p, size_t n, const std::string& strPath)
+	{
+		if (std::fwrite(p, 1, n, pFile) != n)
+		{
+			std::fclose(pFile);
+			throw std::runtime_error("BigFile: cannot write " + strPath);
+		}
+	}
+
+	static void closeFile(std::FILE* pFile, const std::string& strPath)
+	{
+		if (std::fclose(pFile) != 0)
+			throw std::runtime_error("BigFile: cannot write " + strPath);
+	}
+
+public:
+	// read a number in either format. throw std::runtime_error on file errors and std::invalid_argument on bad digits.
+	static BigInt read(const std::string& strPath)
+	{
+		MappedFile fileIn(strPath);
+		if (isBinary(fileIn.data(), fileIn.size()))
+			return parseBinary(fileIn.data(), fileIn.size());
+		BigInt biNum = parseDecimal(fileIn.data(), fileIn.size());
+		// the conversion needs far more scratch than the arithmetic on the result
+		BigScratch::current().trim();
+		return biNum;
+	}
+
+	// write base-10 text followed by a new line
+	static void writeDecimal(const std::string& strPath, const BigInt& biNum)
+	{
+		const std::vector<limb_t>& vMag = biNum.limbs();
+		std::vector<limb_t> vChunks = BigConvert::toChunks(vMag.data(), vMag.size());
+		BigScratch::current().trim();
+
+		std::FILE* pFile = openForWrite(strPath);
+		std::string strTop = (biNum.isNegative() ? "-" : "") + std::to_string(vChunks.back());
+		writeBytes(pFile, strTop.data(), strTop.size(), strPath);
+
+		// the remaining chunks from the most significant one, a block at a time, each block split over threads
+		std::vector<char> vBuffer(std::min(vChunks.size()-1, (size_t)WRITE_BLOCK_CHUNKS) * BigConvert::CHUNK_DIGITS);
+		for (size_t nHi=vChunks.size()-1; nHi>0; )
+		{
+			size_t nLen = std::min(nHi, (size_t)WRITE_BLOCK_CHUNKS);
+			size_t nParts = std::min<size_t>(BigThreads::count(), (nLen + 4095) / 4096);
+			size_t nPart = (nLen + nParts - 1) / nParts;
+			BigThreads::parallelFor(nParts, [&](size_t t) {
+				size_t nOffset = std::min(t*nPart, nLen);
+				size_t nCount = std::min(nPart, nLen - nOffset);
+				BigConvert::formatChunks(vBuffer.data() + nOffset*BigConvert::CHUNK_DIGITS, vChunks.data() + nHi - nOffset - nCount, nCount);
+			});
+			writeBytes(pFile, vBuffer.data(), nLen*BigConvert::CHUNK_DIGITS, strPath);
+			nHi -= nLen;
+		}
+		writeBytes(pFile, "\n", 1, strPath);
+		closeFile(pFile, strPath);
+	}
+
+	// write the binary format
+	static void writeBinary(const std::string& strPath, const BigInt& biNum)
+	{
+		const std::vector<limb_t>& vMag = biNum.limbs();
+		std::FILE* pFile = openForWrite(strPath);
+		writeBytes(pFile, biNum.isNegative() ? "BIGN-" : "BIGN+", 5, strPath);
+		size_t nBytes = vMag.size() * sizeof(limb_t);
+		while ((nBytes > 0) && (((vMag[(nBytes-1) / sizeof(limb_t)] >> (8 * ((nBytes-1) % sizeof(limb_t)))) & 0xFF) == 0))
+			nBytes--;
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__)
+		writeBytes(pFile, vMag.data(), nBytes, strPath);
+#else
+		std::vector<unsigned char> vBytes(nBytes);
+		for (size_t i=0; i<nBytes; i++)
+			vBytes[i] = (unsigned char)(vMag[i / sizeof(limb_t)] >> (8 * (i % sizeof(limb_t))));
+		writeBytes(pFile, vBytes.data(), nBytes, strPath);
+#endif
+		closeFile(pFile, strPath);
+	}
+
+	// write in the binary format when the path ends in ".bin", in decimal otherwise
+	static void write(const std::string& strPath, const BigInt& biNum)
+	{
+		if ((strPath.size() >= 4) && (strPath.compare(strPath.size()-4, 4, ".bin") == 0))
+			writeBinary(strPath, biNum);
+		else
+			writeDecimal(strPath, biNum);
+	}
+};
+
+#endif
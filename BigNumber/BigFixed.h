@@ -0,0 +1,335 @@
+/* BigFixed.h
+**
+** Fixed-width integers of Bits bits held in an array of 64-bit limbs, for bounded values (256 or 512 bits, ...)
+** that should be computed without any heap allocation.
+**  BigUInt<Bits>: unsigned, arithmetic modulo 2^Bits like the built-in unsigned types.
+**  BigSInt<Bits>: signed in two's complement on the same limbs.
+** (the signed template is not called BigInt<Bits> because BigInt is the arbitrary precision class.)
+**
+** The limb count is a compile-time constant, so the loops are unrolled by the compiler, and every operation
+** except the conversions from and to BigInt and strings is constexpr, so constants can be folded at compile time.
+** Carries use the _addcarry_u64 / _subborrow_u64 intrinsics on x86-64 and __builtin_add_overflow elsewhere
+** and in constant expressions. mulWide gives the full double-width product.
+**
+** compiled and tested with g++ 12.2.0 (uses unsigned __int128)
+**
+** MIT License
+** Copyright (c) 2017 636F57@GitHub
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE
+*/
+
+#ifndef BIGFIXED_H
+#define BIGFIXED_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <iostream>
+#include "BigInt.h"
+
+// the x86-64 add-with-carry intrinsics give a single adc chain, which the portable overflow builtins do not
+// always get. they cannot run in constant expressions, so constant evaluation takes the portable path.
+#if defined(__x86_64__) && defined(__GNUC__) && ((__GNUC__ >= 9) || defined(__clang__))
+#include <x86intrin.h>
+#define BIGFIXED_ADDCARRY 1
+#else
+#define BIGFIXED_ADDCARRY 0
+#endif
+
+template<size_t Bits>
+class BigUInt
+{
+public:
+	typedef uint64_t limb_t;
+	static const int LIMB_BITS = 64;
+	static const size_t LIMBS = Bits / 64;
+	static_assert((Bits % 64 == 0) && (Bits > 0), "BigUInt: Bits must be a positive multiple of 64");
+
+private:
+	limb_t aLimbs[LIMBS];  // little-endian
+
+	// r = a + b + nCarry. return the carry out (0 or 1)
+	static constexpr limb_t addCarry(limb_t& r, limb_t a, limb_t b, limb_t nCarry)
+	{
+#if BIGFIXED_ADDCARRY
+		if (!__builtin_is_constant_evaluated())
+		{
+			unsigned long long uOut = 0;
+			unsigned char nOut = _addcarry_u64((unsigned char)nCarry, a, b, &uOut);
+			r = uOut;
+			return nOut;
+		}
+#endif
+		limb_t nSum = 0;
+		limb_t nOut = __builtin_add_overflow(a, b, &nSum);
+		nOut += __builtin_add_overflow(nSum, nCarry, &r);
+		return nOut;
+	}
+
+	// r = a - b - nBorrow. return the borrow out (0 or 1)
+	static constexpr limb_t subBorrow(limb_t& r, limb_t a, limb_t b, limb_t nBorrow)
+	{
+#if BIGFIXED_ADDCARRY
+		if (!__builtin_is_constant_evaluated())
+		{
+			unsigned long long uOut = 0;
+			unsigned char nOut = _subborrow_u64((unsigned char)nBorrow, a, b, &uOut);
+			r = uOut;
+			return nOut;
+		}
+#endif
+		limb_t nDiff = 0;
+		limb_t nOut = __builtin_sub_overflow(a, b, &nDiff);
+		nOut += __builtin_sub_overflow(nDiff, nBorrow, &r);
+		return nOut;
+	}
+
+public:
+	constexpr BigUInt() : aLimbs{} {}
+
+	constexpr BigUInt(uint64_t uNum) : aLimbs{}
+	{
+		aLimbs[0] = uNum;
+	}
+
+	// value modulo 2^Bits (two's complement for negative values)
+	explicit BigUInt(const BigInt& biNum) : aLimbs{}
+	{
+		const std::vector<BigInt::limb_t>& vMag = biNum.limbs();
+		for (size_t i=0; (i < vMag.size()) && (i/2 < LIMBS); i++)
+			aLimbs[i/2] |= (limb_t)vMag[i] << (BigKernels::LIMB_BITS * (i%2));
+		if (biNum.isNegative())
+			*this = BigUInt() - *this;
+	}
+
+	// parse a base-10 integer, taken modulo 2^Bits. throw std::invalid_argument on an invalid character.
+	explicit BigUInt(const std::string& strNum) : BigUInt(BigInt(strNum)) {}
+
+	BigInt toBigInt() const
+	{
+		std::vector<BigInt::limb_t> vMag(2*LIMBS);
+		for (size_t i=0; i<LIMBS; i++)
+		{
+			vMag[2*i] = (BigInt::limb_t)aLimbs[i];
+			vMag[2*i+1] = (BigInt::limb_t)(aLimbs[i] >> BigKernels::LIMB_BITS);
+		}
+		return BigInt::fromLimbs(vMag);
+	}
+
+	std::string toString() const
+	{
+		return toBigInt().toString();
+	}
+
+	constexpr limb_t limb(size_t i) const { return aLimbs[i]; }
+	constexpr void setLimb(size_t i, limb_t nValue) { aLimbs[i] = nValue; }
+
+	constexpr bool isZero() const
+	{
+		limb_t nOr = 0;
+		for (size_t i=0; i<LIMBS; i++)
+			nOr |= aLimbs[i];
+		return nOr == 0;
+	}
+
+	// r = a + b. return the carry out of the top limb
+	static constexpr limb_t add(BigUInt& r, const BigUInt& a, const BigUInt& b)
+	{
+		limb_t nCarry = 0;
+		for (size_t i=0; i<LIMBS; i++)
+			nCarry = addCarry(r.aLimbs[i], a.aLimbs[i], b.aLimbs[i], nCarry);
+		return nCarry;
+	}
+
+	// r = a - b. return the borrow out of the top limb
+	static constexpr limb_t sub(BigUInt& r, const BigUInt& a, const BigUInt& b)
+	{
+		limb_t nBorrow = 0;
+		for (size_t i=0; i<LIMBS; i++)
+			nBorrow = subBorrow(r.aLimbs[i], a.aLimbs[i], b.aLimbs[i], nBorrow);
+		return nBorrow;
+	}
+
+	// full product of Bits+Bits bits
+	static constexpr BigUInt<2*Bits> mulWide(const BigUInt& a, const BigUInt& b)
+	{
+		BigUInt<2*Bits> r;
+		for (size_t i=0; i<LIMBS; i++)
+		{
+			unsigned __int128 uCarry = 0;
+			for (size_t j=0; j<LIMBS; j++)
+			{
+				uCarry += (unsigned __int128)a.aLimbs[i] * b.aLimbs[j] + r.limb(i+j);
+				r.setLimb(i+j, (limb_t)uCarry);
+				uCarry >>= LIMB_BITS;
+			}
+			r.setLimb(i+LIMBS, (limb_t)uCarry);
+		}
+		return r;
+	}
+
+	// low half of a full product of Bits or more bits
+	template<size_t WideBits>
+	static constexpr BigUInt truncate(const BigUInt<WideBits>& a)
+	{
+		static_assert(WideBits >= Bits, "BigUInt: truncate to a wider type");
+		BigUInt r;
+		for (size_t i=0; i<LIMBS; i++)
+			r.aLimbs[i] = a.limb(i);
+		return r;
+	}
+
+	// compare. return -1, 0 or 1
+	static constexpr int compare(const BigUInt& a, const BigUInt& b)
+	{
+		for (size_t i=LIMBS; i>0; i--)
+		{
+			if (a.aLimbs[i-1] != b.aLimbs[i-1])
+				return (a.aLimbs[i-1] < b.aLimbs[i-1]) ? -1 : 1;
+		}
+		return 0;
+	}
+
+	constexpr BigUInt& operator+=(const BigUInt& b) { add(*this, *this, b); return *this; }
+	constexpr BigUInt& operator-=(const BigUInt& b) { sub(*this, *this, b); return *this; }
+	constexpr BigUInt& operator*=(const BigUInt& b) { *this = *this * b; return *this; }
+
+	// product modulo 2^Bits. only the limbs below LIMBS are computed.
+	friend constexpr BigUInt operator*(const BigUInt& a, const BigUInt& b)
+	{
+		BigUInt r;
+		for (size_t i=0; i<LIMBS; i++)
+		{
+			unsigned __int128 uCarry = 0;
+			for (size_t j=0; i+j<LIMBS; j++)
+			{
+				uCarry += (unsigned __int128)a.aLimbs[i] * b.aLimbs[j] + r.aLimbs[i+j];
+				r.aLimbs[i+j] = (limb_t)uCarry;
+				uCarry >>= LIMB_BITS;
+			}
+		}
+		return r;
+	}
+
+	friend constexpr BigUInt operator+(BigUInt a, const BigUInt& b) { return a += b; }
+	friend constexpr BigUInt operator-(BigUInt a, const BigUInt& b) { return a -= b; }
+
+	// shifts by 0 <= nShift < Bits
+	friend constexpr BigUInt operator<<(const BigUInt& a, size_t nShift)
+	{
+		BigUInt r;
+		size_t nLimbs = nShift / LIMB_BITS;
+		int nBits = nShift % LIMB_BITS;
+		for (size_t i=LIMBS; i>nLimbs; i--)
+		{
+			limb_t nValue = a.aLimbs[i-1-nLimbs] << nBits;
+			if ((nBits > 0) && (i-1-nLimbs > 0))
+				nValue |= a.aLimbs[i-2-nLimbs] >> (LIMB_BITS - nBits);
+			r.aLimbs[i-1] = nValue;
+		}
+		return r;
+	}
+
+	friend constexpr BigUInt operator>>(const BigUInt& a, size_t nShift)
+	{
+		BigUInt r;
+		size_t nLimbs = nShift / LIMB_BITS;
+		int nBits = nShift % LIMB_BITS;
+		for (size_t i=0; i+nLimbs<LIMBS; i++)
+		{
+			limb_t nValue = a.aLimbs[i+nLimbs] >> nBits;
+			if ((nBits > 0) && (i+nLimbs+1 < LIMBS))
+				nValue |= a.aLimbs[i+nLimbs+1] << (LIMB_BITS - nBits);
+			r.aLimbs[i] = nValue;
+		}
+		return r;
+	}
+
+	friend constexpr bool operator==(const BigUInt& a, const BigUInt& b) { return compare(a, b) == 0; }
+	friend constexpr bool operator!=(const BigUInt& a, const BigUInt& b) { return compare(a, b) != 0; }
+	friend constexpr bool operator<(const BigUInt& a, const BigUInt& b) { return compare(a, b) < 0; }
+	friend constexpr bool operator>(const BigUInt& a, const BigUInt& b) { return compare(a, b) > 0; }
+	friend constexpr bool operator<=(const BigUInt& a, const BigUInt& b) { return compare(a, b) <= 0; }
+	friend constexpr bool operator>=(const BigUInt& a, const BigUInt& b) { return compare(a, b) >= 0; }
+
+	friend std::ostream& operator<<(std::ostream& os, const BigUInt& a)
+	{
+		return os << a.toString();
+	}
+};
+
+template<size_t Bits>
+class BigSInt
+{
+public:
+	typedef typename BigUInt<Bits>::limb_t limb_t;
+	static const size_t LIMBS = BigUInt<Bits>::LIMBS;
+
+private:
+	BigUInt<Bits> uBits;  // two's complement bit pattern
+
+public:
+	constexpr BigSInt() : uBits() {}
+
+	constexpr BigSInt(int64_t lNum) : uBits((uint64_t)lNum)
+	{
+		for (size_t i=1; i<LIMBS; i++)
+			uBits.setLimb(i, (lNum < 0) ? ~(limb_t)0 : 0);
+	}
+
+	constexpr explicit BigSInt(const BigUInt<Bits>& uPattern) : uBits(uPattern) {}
+
+	// value modulo 2^Bits, read back in [-2^(Bits-1), 2^(Bits-1))
+	explicit BigSInt(const BigInt& biNum) : uBits(biNum) {}
+
+	explicit BigSInt(const std::string& strNum) : uBits(BigInt(strNum)) {}
+
+	BigInt toBigInt() const
+	{
+		if (!isNegative())
+			return uBits.toBigInt();
+		return -(BigUInt<Bits>() - uBits).toBigInt();
+	}
+
+	std::string toString() const
+	{
+		return toBigInt().toString();
+	}
+
+	constexpr const BigUInt<Bits>& bits() const { return uBits; }
+	constexpr bool isZero() const { return uBits.isZero(); }
+	constexpr bool isNegative() const { return (uBits.limb(LIMBS-1) >> (BigUInt<Bits>::LIMB_BITS-1)) != 0; }
+
+	// compare the signed values. return -1, 0 or 1
+	static constexpr int compare(const BigSInt& a, const BigSInt& b)
+	{
+		if (a.isNegative() != b.isNegative())
+			return a.isNegative() ? -1 : 1;
+		return BigUInt<Bits>::compare(a.uBits, b.uBits);
+	}
+
+	// the same bit operations as the unsigned type, wrapping modulo 2^Bits
+	constexpr BigSInt operator-() const { return BigSInt(BigUInt<Bits>() - uBits); }
+	constexpr BigSInt& operator+=(const BigSInt& b) { uBits += b.uBits; return *this; }
+	constexpr BigSInt& operator-=(const BigSInt& b) { uBits -= b.uBits; return *this; }
+	constexpr BigSInt& operator*=(const BigSInt& b) { uBits *= b.uBits; return *this; }
+
+	friend constexpr BigSInt operator+(BigSInt a, const BigSInt& b) { return a += b; }
+	friend constexpr BigSInt operator-(BigSInt a, const BigSInt& b) { return a -= b; }
+	friend constexpr BigSInt operator*(BigSInt a, const BigSInt& b) { return a *= b; }
+
+	friend constexpr bool operator==(const BigSInt& a, const BigSInt& b) { return compare(a, b) == 0; }
+	friend constexpr bool operator!=(const BigSInt& a, const BigSInt& b) { return compare(a, b) != 0; }
+	friend constexpr bool operator<(const BigSInt& a, const BigSInt& b) { return compare(a, b) < 0; }
+	friend constexpr bool operator>(const BigSInt& a, const BigSInt& b) { return compare(a, b) > 0; }
+	friend constexpr bool operator<=(const BigSInt& a, const BigSInt& b) { return compare(a, b) <= 0; }
+	friend constexpr bool operator>=(const BigSInt& a, const BigSInt& b) { return compare(a, b) >= 0; }
+
+	friend std::ostream& operator<<(std::ostream& os, const BigSInt& a)
+	{
+		return os << a.toString();
+	}
+};
+
+#endif
@@ -0,0 +1,267 @@
+/* BigInt.h
+**
+** Arbitrary precision signed integer class.
+**
+** The magnitude is held in 32-bit binary limbs (see BigKernels.h) with a separate sign flag,
+** so chained arithmetic stays in the native form and decimal strings are only touched on input and output
+** (see BigConvert.h for the conversion).
+** Zero is always represented as an empty magnitude with positive sign.
+**
+** compiled and tested with g++ 12.2.0
+**
+** MIT License
+** Copyright (c) 2017 636F57@GitHub
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE
+*/
+
+#ifndef BIGINT_H
+#define BIGINT_H
+
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include "BigKernels.h"
+#include "BigConvert.h"
+#include "BigScratch.h"
+
+class BigInt
+{
+public:
+	typedef BigKernels::limb_t limb_t;
+	typedef BigKernels::dlimb_t dlimb_t;
+
+private:
+	std::vector<limb_t> vMag;  // magnitude, little-endian limbs without leading zero limbs
+	bool bNeg = false;
+
+	// drop the leading zero limbs and clear the sign of zero
+	void trim()
+	{
+		vMag.resize(BigKernels::normSize(vMag.data(), vMag.size()));
+		if (vMag.empty())
+			bNeg = false;
+	}
+
+	// divmod with the quotient and the remainder each optional (null). they may be the same objects as a or b.
+	// the kernel works in scratch memory and the results are copied into the existing magnitudes.
+	static void divmodTo(const BigInt& a, const BigInt& b, BigInt* pQuot, BigInt* pRem)
+	{
+		if (b.vMag.empty())
+			throw std::domain_error("BigInt: division by zero");
+		if (compareAbs(a, b) < 0)
+		{
+			if (pRem != nullptr)
+				*pRem = a;
+			if (pQuot != nullptr)
+				*pQuot = BigInt();
+			return;
+		}
+
+		size_t na = a.vMag.size(), nb = b.vMag.size();
+		bool bNegQuot = (a.bNeg != b.bNeg);
+		bool bNegRem = a.bNeg;
+		BigScratch::Frame frame;
+		limb_t* pQuotLimbs = frame.allocate<limb_t>(na-nb+1);
+		limb_t* pRemLimbs = frame.allocate<limb_t>(nb);
+		BigKernels::divmod(pQuotLimbs, pRemLimbs, a.vMag.data(), na, b.vMag.data(), nb);
+		if (pQuot != nullptr)
+		{
+			pQuot->vMag.assign(pQuotLimbs, pQuotLimbs + na-nb+1);
+			pQuot->bNeg = bNegQuot;
+			pQuot->trim();
+		}
+		if (pRem != nullptr)
+		{
+			pRem->vMag.assign(pRemLimbs, pRemLimbs + nb);
+			pRem->bNeg = bNegRem;
+			pRem->trim();
+		}
+	}
+
+	// add |b| to this with the sign given by bNegB. used for both addition and subtraction
+	void addSigned(const BigInt& b, bool bNegB)
+	{
+		if (b.vMag.empty())
+			return;
+		if (bNeg == bNegB)
+		{
+			size_t nSize = std::max(vMag.size(), b.vMag.size());
+			vMag.resize(nSize + 1, 0);
+			limb_t nCarry = BigKernels::add(vMag.data(), vMag.data(), nSize, b.vMag.data(), b.vMag.size());
+			vMag[nSize] = nCarry;
+		}
+		else if (compareAbs(*this, b) >= 0)
+		{
+			BigKernels::sub(vMag.data(), vMag.data(), vMag.size(), b.vMag.data(), b.vMag.size());
+		}
+		else
+		{
+			BigScratch::Frame frame;
+			limb_t* pDiff = frame.allocate<limb_t>(b.vMag.size());
+			BigKernels::sub(pDiff, b.vMag.data(), b.vMag.size(), vMag.data(), vMag.size());
+			vMag.assign(pDiff, pDiff + b.vMag.size());
+			bNeg = bNegB;
+		}
+		trim();
+	}
+
+public:
+	BigInt(){}
+	~BigInt(){}
+
+	BigInt(long long lNum)
+	{
+		unsigned long long ulMag = (lNum < 0) ? 0ULL - (unsigned long long)lNum : (unsigned long long)lNum;
+		while (ulMag > 0)
+		{
+			vMag.push_back((limb_t)ulMag);
+			ulMag >>= BigKernels::LIMB_BITS;
+		}
+		bNeg = (lNum < 0);
+	}
+
+	// parse a base-10 integer with an optional leading '-' or '+'. throw std::invalid_argument on other characters.
+	explicit BigInt(const std::string& strNum)
+	{
+		size_t nPos = 0;
+		bool bNegIn = false;
+		if ((strNum.size() > 0) && ((strNum[0] == '-') || (strNum[0] == '+')))
+		{
+			bNegIn = (strNum[0] == '-');
+			nPos = 1;
+		}
+		if (nPos == strNum.size())
+			throw std::invalid_argument("BigInt: no digits in \"" + strNum + "\"");
+		vMag = BigConvert::fromDecimal(strNum.data() + nPos, strNum.size() - nPos);
+		bNeg = bNegIn;
+		trim();
+	}
+
+	// return the base-10 representation
+	std::string toString() const
+	{
+		if (vMag.empty())
+			return std::string("0");
+		return (bNeg ? "-" : "") + BigConvert::toDecimal(vMag.data(), vMag.size());
+	}
+
+	bool isZero() const { return vMag.empty(); }
+	bool isNegative() const { return bNeg; }
+	int sign() const { return vMag.empty() ? 0 : (bNeg ? -1 : 1); }
+	size_t limbCount() const { return vMag.size(); }
+	const std::vector<limb_t>& limbs() const { return vMag; }
+
+	// build from a magnitude given as little-endian limbs
+	static BigInt fromLimbs(std::vector<limb_t> vLimbs, bool bNegative = false)
+	{
+		BigInt biResult;
+		biResult.vMag.swap(vLimbs);
+		biResult.bNeg = bNegative;
+		biResult.trim();
+		return biResult;
+	}
+
+	// compare the absolute values. return -1, 0 or 1
+	static int compareAbs(const BigInt& a, const BigInt& b)
+	{
+		return BigKernels::cmp(a.vMag.data(), a.vMag.size(), b.vMag.data(), b.vMag.size());
+	}
+
+	// compare the signed values. return -1, 0 or 1
+	static int compare(const BigInt& a, const BigInt& b)
+	{
+		if (a.bNeg != b.bNeg)
+			return a.bNeg ? -1 : 1;
+		int nCmp = compareAbs(a, b);
+		return a.bNeg ? -nCmp : nCmp;
+	}
+
+	BigInt operator-() const
+	{
+		BigInt biResult(*this);
+		if (!biResult.vMag.empty())
+			biResult.bNeg = !bNeg;
+		return biResult;
+	}
+
+	BigInt& operator+=(const BigInt& b)
+	{
+		addSigned(b, b.bNeg);
+		return *this;
+	}
+
+	BigInt& operator-=(const BigInt& b)
+	{
+		addSigned(b, !b.bNeg);
+		return *this;
+	}
+
+	// the product is made in scratch memory and copied back, so the magnitude keeps its capacity
+	BigInt& operator*=(const BigInt& b)
+	{
+		if (vMag.empty() || b.vMag.empty())
+		{
+			*this = BigInt();
+			return *this;
+		}
+		size_t nSize = vMag.size() + b.vMag.size();
+		BigScratch::Frame frame;
+		limb_t* pProduct = frame.allocate<limb_t>(nSize);
+		BigKernels::mul(pProduct, vMag.data(), vMag.size(), b.vMag.data(), b.vMag.size());
+		vMag.assign(pProduct, pProduct + nSize);
+		bNeg = (bNeg != b.bNeg);
+		trim();
+		return *this;
+	}
+
+	BigInt& operator/=(const BigInt& b)
+	{
+		divmodTo(*this, b, this, nullptr);
+		return *this;
+	}
+
+	BigInt& operator%=(const BigInt& b)
+	{
+		divmodTo(*this, b, nullptr, this);
+		return *this;
+	}
+
+	// quotient rounded toward zero and the remainder with the sign of a, as for the built-in integers.
+	// throw std::domain_error when b is zero.
+	static void divmod(const BigInt& a, const BigInt& b, BigInt& biQuot, BigInt& biRem)
+	{
+		divmodTo(a, b, &biQuot, &biRem);
+	}
+
+	friend BigInt operator+(BigInt a, const BigInt& b) { a += b; return a; }
+	friend BigInt operator-(BigInt a, const BigInt& b) { a -= b; return a; }
+	friend BigInt operator/(BigInt a, const BigInt& b) { a /= b; return a; }
+	friend BigInt operator%(BigInt a, const BigInt& b) { a %= b; return a; }
+
+	friend BigInt operator*(const BigInt& a, const BigInt& b)
+	{
+		BigInt biResult;
+		if (a.vMag.empty() || b.vMag.empty())
+			return biResult;
+		biResult.vMag.resize(a.vMag.size() + b.vMag.size());
+		BigKernels::mul(biResult.vMag.data(), a.vMag.data(), a.vMag.size(), b.vMag.data(), b.vMag.size());
+		biResult.bNeg = (a.bNeg != b.bNeg);
+		biResult.trim();
+		return biResult;
+	}
+
+	friend bool operator==(const BigInt& a, const BigInt& b) { return (a.bNeg == b.bNeg) && (a.vMag == b.vMag); }
+	friend bool operator!=(const BigInt& a, const BigInt& b) { return !(a == b); }
+	friend bool operator<(const BigInt& a, const BigInt& b) { return compare(a, b) < 0; }
+	friend bool operator>(const BigInt& a, const BigInt& b) { return compare(a, b) > 0; }
+	friend bool operator<=(const BigInt& a, const BigInt& b) { return compare(a, b) <= 0; }
+	friend bool operator>=(const BigInt& a, const BigInt& b) { return compare(a, b) >= 0; }
+
+	friend std::ostream& operator<<(std::ostream& os, const BigInt& a)
+	{
+		return os << a.toString();
+	}
+};
+
+#endif
@@ -0,0 +1,1060 @@
+/* BigKernels.h
+**
+** Low level kernels on the magnitude of big integers, used by BigInt.
+**
+** A magnitude is an array of 32-bit binary limbs in little-endian order (limb 0 is the least significant).
+** All functions work on raw pointers and lengths so that they can be applied to any part of a buffer.
+** Caller owns all buffers. Unless noted, output buffers must not overlap the inputs.
+**
+** Addition and subtraction resolve carries by carry-lookahead with AVX2 when the processor has it (checked at run
+** time), and ripple them otherwise, which is faster than a lookahead without vectors.
+** Very long operands are split over BigThreads::count() threads in add/sub, mul (by blocks) and the NTT.
+** Compile with -O3 and -pthread.
+**
+** Multiplication: schoolbook below tuning().nKaratsuba limbs, Karatsuba below tuning().nToom3 limbs, Toom-3 above,
+** and the three-prime NTT of BigNTT.h from tuning().nNTT limbs as long as the product fits in its transform length.
+** The thresholds can be measured on the running machine with calibrateMul() (see tune.cpp).
+** Squaring (sqr, also taken by mul when both operands are the same) uses the same thresholds with variants of
+** each method that exploit the symmetry.
+**
+** Division: Knuth's algorithm D, or from tuning().nDivNewton limbs of divisor and quotient, a Newton-iteration
+** reciprocal so that a division costs a constant number of multiplications.
+**
+** Temporary buffers come from the scratch arena of the calling thread (see BigScratch.h), so repeated operations
+** of similar sizes do no heap allocation.
+**
+** compiled and tested with g++ 12.2.0
+**
+** MIT License
+** Copyright (c) 2017 636F57@GitHub
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE
+*/
+
+#ifndef BIGKERNELS_H
+#define BIGKERNELS_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include "BigNTT.h"
+#include "BigScratch.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BIG_X86_SIMD
+#include <immintrin.h>
+#endif
+
+class BigKernels
+{
+public:
+	typedef uint32_t limb_t;
+	typedef uint64_t dlimb_t;
+	static const int LIMB_BITS = 32;
+
+	// return the length of a[0,n) without the leading zero limbs
+	static size_t normSize(const limb_t* a, size_t n)
+	{
+		while ((n > 0) && (a[n-1] == 0))
+			n--;
+		return n;
+	}
+
+	// compare two normalized magnitudes. return -1 if a<b, 0 if a==b, 1 if a>b
+	static int cmp(const limb_t* a, size_t na, const limb_t* b, size_t nb)
+	{
+		if (na != nb)
+			return (na < nb) ? -1 : 1;
+		for (size_t i=na; i>0; i--)
+		{
+			if (a[i-1] != b[i-1])
+				return (a[i-1] < b[i-1]) ? -1 : 1;
+		}
+		return 0;
+	}
+
+	// r[0,na) = a + b, where na >= nb. return the carry out of the top limb. r may be the same as a.
+	static limb_t add(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+	{
+		limb_t nCarry = addN(r, a, b, nb, 0);
+		for (size_t i=nb; i<na; i++)
+		{
+			if (nCarry == 0)
+			{
+				if (r != a)
+					std::copy(a+i, a+na, r+i);
+				return 0;
+			}
+			r[i] = a[i] + 1;
+			nCarry = (r[i] == 0);
+		}
+		return nCarry;
+	}
+
+	// r[0,na) = a - b, where na >= nb. return the borrow out of the top limb (0 when a >= b). r may be the same as a.
+	static limb_t sub(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+	{
+		limb_t nBorrow = subN(r, a, b, nb, 0);
+		for (size_t i=nb; i<na; i++)
+		{
+			if (nBorrow == 0)
+			{
+				if (r != a)
+					std::copy(a+i, a+na, r+i);
+				return 0;
+			}
+			limb_t nA = a[i];
+			r[i] = nA - 1;
+			nBorrow = (nA == 0) ? 1 : 0;
+		}
+		return nBorrow;
+	}
+
+	// r[0,n) = a + b + nCarry on operands of the same length. return the carry out. r may be the same as a or b.
+	static limb_t addN(limb_t* r, const limb_t* a, const limb_t* b, size_t n, limb_t nCarry)
+	{
+		if ((n >= PARALLEL_ADD_LIMBS) && (BigThreads::count() > 1))
+			return addSubParallel<false>(r, a, b, n, nCarry);
+		return addSubSerial<false>(r, a, b, n, nCarry);
+	}
+
+	// r[0,n) = a - b - nBorrow on operands of the same length. return the borrow out. r may be the same as a or b.
+	static limb_t subN(limb_t* r, const limb_t* a, const limb_t* b, size_t n, limb_t nBorrow)
+	{
+		if ((n >= PARALLEL_ADD_LIMBS) && (BigThreads::count() > 1))
+			return addSubParallel<true>(r, a, b, n, nBorrow);
+		return addSubSerial<true>(r, a, b, n, nBorrow);
+	}
+
+	// r[0,n) = a * m + nAdd. return the carry limb. r may be the same as a.
+	static limb_t mulSmall(limb_t* r, const limb_t* a, size_t n, limb_t m, limb_t nAdd = 0)
+	{
+		dlimb_t dCarry = nAdd;
+		for (size_t i=0; i<n; i++)
+		{
+			dCarry += (dlimb_t)a[i] * m;
+			r[i] = (limb_t)dCarry;
+			dCarry >>= LIMB_BITS;
+		}
+		return (limb_t)dCarry;
+	}
+
+	// q[0,n) = a / d. return the remainder. q may be the same as a.
+	static limb_t divSmall(limb_t* q, const limb_t* a, size_t n, limb_t d)
+	{
+		dlimb_t dRem = 0;
+		for (size_t i=n; i>0; i--)
+		{
+			dRem = (dRem << LIMB_BITS) | a[i-1];
+			q[i-1] = (limb_t)(dRem / d);
+			dRem %= d;
+		}
+		return (limb_t)dRem;
+	}
+
+	// r[0,n) += a * m. return the carry limb.
+	static limb_t addMul(limb_t* r, const limb_t* a, size_t n, limb_t m)
+	{
+		dlimb_t dCarry = 0;
+		for (size_t i=0; i<n; i++)
+		{
+			dCarry += (dlimb_t)a[i] * m + r[i];
+			r[i] = (limb_t)dCarry;
+			dCarry >>= LIMB_BITS;
+		}
+		return (limb_t)dCarry;
+	}
+
+	// r[0,n) = a << nShift for 0 <= nShift < LIMB_BITS. return the bits shifted out. r may be the same as a.
+	static limb_t shiftLeft(limb_t* r, const limb_t* a, size_t n, int nShift)
+	{
+		if (nShift == 0)
+		{
+			std::copy(a, a+n, r);
+			return 0;
+		}
+		limb_t nOut = 0;
+		for (size_t i=0; i<n; i++)
+		{
+			limb_t nA = a[i];
+			r[i] = (nA << nShift) | nOut;
+			nOut = nA >> (LIMB_BITS - nShift);
+		}
+		return nOut;
+	}
+
+	// r[0,n) = a >> nShift for 0 <= nShift < LIMB_BITS. r may be the same as a.
+	static void shiftRight(limb_t* r, const limb_t* a, size_t n, int nShift)
+	{
+		if (nShift == 0)
+		{
+			std::copy(a, a+n, r);
+			return;
+		}
+		for (size_t i=0; i<n; i++)
+		{
+			limb_t nNext = (i+1 < n) ? a[i+1] : 0;
+			r[i] = (a[i] >> nShift) | (nNext << (LIMB_BITS - nShift));
+		}
+	}
+
+	// number of leading zero bits of a non-zero limb
+	static int countLeadingZeros(limb_t x)
+	{
+		int n = 0;
+		while ((x & ((limb_t)1 << (LIMB_BITS-1))) == 0)
+		{
+			x <<= 1;
+			n++;
+		}
+		return n;
+	}
+
+	// r[0,na+nb) = a * b by the schoolbook method.
+	// each row is accumulated in a double limb, so a carry is resolved once per product instead of rippling.
+	static void mulSchool(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+	{
+		std::fill(r, r+na+nb, 0);
+		for (size_t i=0; i<na; i++)
+		{
+			dlimb_t dCarry = 0;
+			dlimb_t dA = a[i];
+			if (dA == 0)
+				continue;
+			for (size_t j=0; j<nb; j++)
+			{
+				dCarry += dA * b[j] + r[i+j];
+				r[i+j] = (limb_t)dCarry;
+				dCarry >>= LIMB_BITS;
+			}
+			r[i+nb] = (limb_t)dCarry;
+		}
+	}
+
+	// r[0,2n) = a^2 by the schoolbook method. each cross product a[i]*a[j] (i<j) is computed once and doubled,
+	// then the squares a[i]^2 are added on the diagonal, which saves nearly half of the products.
+	static void sqrSchool(limb_t* r, const limb_t* a, size_t n)
+	{
+		std::fill(r, r+2*n, 0);
+		for (size_t i=0; i+1<n; i++)
+		{
+			dlimb_t dCarry = 0;
+			dlimb_t dA = a[i];
+			for (size_t j=i+1; j<n; j++)
+			{
+				dCarry += dA * a[j] + r[i+j];
+				r[i+j] = (limb_t)dCarry;
+				dCarry >>= LIMB_BITS;
+			}
+			r[i+n] = (limb_t)dCarry;
+		}
+		shiftLeft(r, r, 2*n, 1);
+
+		dlimb_t dCarry = 0;
+		for (size_t i=0; i<n; i++)
+		{
+			dlimb_t dSquare = (dlimb_t)a[i] * a[i];
+			dCarry += (dlimb_t)r[2*i] + (limb_t)dSquare;
+			r[2*i] = (limb_t)dCarry;
+			dCarry >>= LIMB_BITS;
+			dCarry += (dlimb_t)r[2*i+1] + (dSquare >> LIMB_BITS);
+			r[2*i+1] = (limb_t)dCarry;
+			dCarry >>= LIMB_BITS;
+		}
+	}
+
+	/***************************** Fast multiplication *********************************************/
+
+	// crossover points in limbs
+	struct Tuning
+	{
+		size_t nKaratsuba;  // use Karatsuba from this size of the shorter factor
+		size_t nToom3;      // use Toom-3 from this size of the shorter factor
+		size_t nNTT;        // use NTT from this size of the shorter factor
+		size_t nDivNewton;  // divide by Newton reciprocal from this size of the divisor and the quotient
+	};
+
+	static Tuning& tuning()
+	{
+		static Tuning tuningDefault = {KARATSUBA_THRESHOLD, TOOM3_THRESHOLD, NTT_THRESHOLD, DIV_NEWTON_THRESHOLD};
+		return tuningDefault;
+	}
+
+	// r[0,na+nb) = a * b. entry point which chooses the algorithm. identical operands are squared by sqr().
+	static void mul(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+	{
+		if ((na == nb) && ((a == b) || std::equal(a, a+na, b)))
+		{
+			sqr(r, a, na);
+			return;
+		}
+		if (na < nb)
+		{
+			std::swap(a, b);
+			std::swap(na, nb);
+		}
+		if (nb == 0)
+		{
+			std::fill(r, r+na, 0);
+			return;
+		}
+		if (nb < tuning().nKaratsuba)
+		{
+			mulSchool(r, a, na, b, nb);
+			return;
+		}
+		if ((nb >= tuning().nNTT) && (na+nb <= BigNTT::MAX_LIMBS))
+		{
+			BigNTT::mul(r, a, na, b, nb);
+			return;
+		}
+		if ((nb >= PARALLEL_MUL_LIMBS) && (BigThreads::count() > 1))
+		{
+			mulBlocks(r, a, na, b, nb);
+			return;
+		}
+		if (na >= 2*nb)
+		{
+			mulUnbalanced(r, a, na, b, nb);
+			return;
+		}
+
+		// the split algorithms need operands of the same length, pad the shorter one
+		if (na == nb)
+		{
+			mulBalanced(r, a, b, na);
+		}
+		else
+		{
+			BigScratch::Frame frame;
+			limb_t* pPadB = frame.allocate<limb_t>(na);
+			std::copy(b, b+nb, pPadB);
+			std::fill(pPadB+nb, pPadB+na, 0);
+			limb_t* pTmp = frame.allocate<limb_t>(2*na);
+			mulBalanced(pTmp, a, pPadB, na);
+			std::copy(pTmp, pTmp+na+nb, r);
+		}
+	}
+
+	// r[0,2n) = a^2. entry point which chooses the algorithm, with the same crossover points as mul().
+	// every method uses the symmetry: the schoolbook computes the cross products once, Karatsuba and Toom-3
+	// square their evaluations recursively, and the NTT transforms the operand once instead of twice.
+	static void sqr(limb_t* r, const limb_t* a, size_t n)
+	{
+		if (n == 0)
+			return;
+		if (n < tuning().nKaratsuba)
+		{
+			sqrSchool(r, a, n);
+			return;
+		}
+		if ((n >= tuning().nNTT) && (2*n <= BigNTT::MAX_LIMBS))
+		{
+			BigNTT::sqr(r, a, n);
+			return;
+		}
+		if ((n >= PARALLEL_MUL_LIMBS) && (BigThreads::count() > 1))
+		{
+			mulBlocks(r, a, n, a, n);
+			return;
+		}
+		sqrBalanced(r, a, n);
+	}
+
+	// measure the crossover points on this machine and store them in tuning().
+	// takes a few seconds. nMaxSize is the largest operand size (in limbs) tried for Toom-3 and NTT.
+	static Tuning calibrateMul(size_t nMaxSize = 65536)
+	{
+		Tuning& tuningCur = tuning();
+		tuningCur.nToom3 = (size_t)-1;
+		tuningCur.nNTT = (size_t)-1;
+
+		// Karatsuba: the smallest size where one level of Karatsuba over schoolbook wins
+		size_t nKaratsuba = 0;
+		for (size_t n=8; n<=512; n+=n/4)
+		{
+			tuningCur.nKaratsuba = n + 1;
+			double dSchool = timeMul(n);
+			tuningCur.nKaratsuba = n;
+			double dKaratsuba = timeMul(n);
+			if (dKaratsuba < dSchool)
+			{
+				nKaratsuba = n;
+				break;
+			}
+		}
+		tuningCur.nKaratsuba = (nKaratsuba > 0) ? nKaratsuba : 512;
+
+		// Toom-3: the smallest size where one level of Toom-3 over tuned Karatsuba wins
+		size_t nToom3 = 0;
+		for (size_t n=std::max<size_t>(3*tuningCur.nKaratsuba, 48); n<=std::min<size_t>(nMaxSize, 4096); n+=n/4)
+		{
+			tuningCur.nToom3 = n + 1;
+			double dKaratsuba = timeMul(n);
+			tuningCur.nToom3 = n;
+			double dToom3 = timeMul(n);
+			if (dToom3 < dKaratsuba)
+			{
+				nToom3 = n;
+				break;
+			}
+		}
+		tuningCur.nToom3 = (nToom3 > 0) ? nToom3 : (size_t)-1;
+
+		// NTT: the smallest size where the transform beats the tuned split methods
+		size_t nNTT = 0;
+		for (size_t n=256; n<=nMaxSize; n+=n/4)
+		{
+			tuningCur.nNTT = (size_t)-1;
+			double dSplit = timeMul(n);
+			tuningCur.nNTT = n;
+			double dNTT = timeMul(n);
+			if (dNTT < dSplit)
+			{
+				nNTT = n;
+				break;
+			}
+		}
+		tuningCur.nNTT = (nNTT > 0) ? nNTT : (size_t)-1;
+
+		return tuningCur;
+	}
+
+	/***************************** Division ********************************************************/
+
+	// q[0,na-nb+1) = a / b and rem[0,nb) = a % b, where na >= nb >= 1 and b[nb-1] != 0.
+	// q or rem can be null when not needed. neither may overlap the inputs.
+	static void divmod(limb_t* q, limb_t* rem, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+	{
+		if (nb == 1)
+		{
+			BigScratch::Frame frame;
+			limb_t* pQ = frame.allocate<limb_t>(na);
+			limb_t nRem = divSmall(pQ, a, na, b[0]);
+			if (q != nullptr)
+				std::copy(pQ, pQ+na, q);
+			if (rem != nullptr)
+				rem[0] = nRem;
+			return;
+		}
+		if ((nb >= tuning().nDivNewton) && (na-nb+1 >= tuning().nDivNewton))
+			divNewton(q, rem, a, na, b, nb);
+		else
+			divSchool(q, rem, a, na, b, nb);
+	}
+
+private:
+	static const size_t LOOKAHEAD_LIMBS = 64;         // below this, the carry is simply rippled
+	static const size_t PARALLEL_ADD_LIMBS = 1 << 20;  // from this, add/sub is split over threads
+	static const size_t PARALLEL_MUL_LIMBS = 1 << 12;  // from this, mul outside the NTT range is split over threads
+	static const size_t KARATSUBA_THRESHOLD = 32;
+	static const size_t TOOM3_THRESHOLD = 192;
+	static const size_t NTT_THRESHOLD = 3072;
+	static const size_t DIV_NEWTON_THRESHOLD = 256;
+	static const size_t RECIPROCAL_BASECASE = 32;  // exact reciprocal by algorithm D below this size
+
+	// intermediate value of Toom-3 and Newton division which can be negative
+	struct SignedLimbs
+	{
+		BigScratch::Vector<limb_t> vMag;
+		bool bNeg;
+	};
+
+	/***************************** Carry-lookahead add/sub ******************************************/
+
+	// r[0,n) = a +- b +- nCarry with the carry rippled limb by limb
+	template<bool SUB>
+	static limb_t addSubRipple(limb_t* r, const limb_t* a, const limb_t* b, size_t n, limb_t nCarry)
+	{
+		for (size_t i=0; i<n; i++)
+		{
+			dlimb_t dTmp = SUB ? (dlimb_t)a[i] - b[i] - nCarry : (dlimb_t)a[i] + b[i] + nCarry;
+			r[i] = (limb_t)dTmp;
+			nCarry = (limb_t)(dTmp >> LIMB_BITS) & 1;
+		}
+		return nCarry;
+	}
+
+	// the lookahead only beats the ripple with AVX2, which is checked once at run time
+	template<bool SUB>
+	static limb_t addSubSerial(limb_t* r, const limb_t* a, const limb_t* b, size_t n, limb_t nCarry)
+	{
+#ifdef BIG_X86_SIMD
+		static const bool bAvx2 = (__builtin_cpu_init(), __builtin_cpu_supports("avx2"));
+		if (bAvx2 && (n >= LOOKAHEAD_LIMBS))
+			return addSubLookahead<SUB>(r, a, b, n, nCarry);
+#endif
+		return addSubRipple<SUB>(r, a, b, n, nCarry);
+	}
+
+#ifdef BIG_X86_SIMD
+	// r[0,n) = a +- b +- nCarry with the carries resolved by carry-lookahead on groups of 64 limbs.
+	// a limb generates a carry when the limb-wise sum wraps around and propagates one when the sum is all ones
+	// (for subtraction: borrows when a < b, propagates when the difference is zero). with the generate and
+	// propagate bits of a group packed in the masks G and P, the carries into every limb are ((G<<1)+P+c)^P,
+	// so the only serial step is one 64-bit addition per group, and the limbs are added 8 at a time with AVX2.
+	template<bool SUB>
+	__attribute__((target("avx2")))
+	static limb_t addSubLookahead(limb_t* r, const limb_t* a, const limb_t* b, size_t n, limb_t nCarry)
+	{
+		const size_t GROUP = 64;
+		const __m256i vSign = _mm256_set1_epi32((int)0x80000000);
+		const __m256i vPropagate = SUB ? _mm256_setzero_si256() : _mm256_set1_epi32(-1);
+		const __m256i vBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+		size_t i = 0;
+		for (; i+GROUP<=n; i+=GROUP)
+		{
+			uint64_t uGen = 0, uProp = 0;
+			for (size_t j=0; j<GROUP; j+=8)
+			{
+				__m256i vA = _mm256_loadu_si256((const __m256i*)(a+i+j));
+				__m256i vB = _mm256_loadu_si256((const __m256i*)(b+i+j));
+				__m256i vSum = SUB ? _mm256_sub_epi32(vA, vB) : _mm256_add_epi32(vA, vB);
+				_mm256_storeu_si256((__m256i*)(r+i+j), vSum);
+				// unsigned comparisons as signed ones on the values with the sign bit flipped
+				__m256i vGen = SUB ? _mm256_cmpgt_epi32(_mm256_xor_si256(vB, vSign), _mm256_xor_si256(vA, vSign))
+				                   : _mm256_cmpgt_epi32(_mm256_xor_si256(vA, vSign), _mm256_xor_si256(vSum, vSign));
+				__m256i vProp = _mm256_cmpeq_epi32(vSum, vPropagate);
+				uGen |= (uint64_t)(uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(vGen)) << j;
+				uProp |= (uint64_t)(uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(vProp)) << j;
+			}
+			uint64_t uCarries = ((uGen << 1) + uProp + nCarry) ^ uProp;
+			for (size_t j=0; j<GROUP; j+=8)
+			{
+				// all ones in the limbs which take a carry, so that subtracting it adds 1 (adding it subtracts 1)
+				__m256i vMask = _mm256_set1_epi32((int)((uCarries >> j) & 0xFF));
+				vMask = _mm256_cmpeq_epi32(_mm256_and_si256(vMask, vBits), vBits);
+				__m256i vR = _mm256_loadu_si256((const __m256i*)(r+i+j));
+				vR = SUB ? _mm256_add_epi32(vR, vMask) : _mm256_sub_epi32(vR, vMask);
+				_mm256_storeu_si256((__m256i*)(r+i+j), vR);
+			}
+			nCarry = (limb_t)(((uGen | (uProp & uCarries)) >> (GROUP-1)) & 1);
+		}
+		return addSubRipple<SUB>(r+i, a+i, b+i, n-i, nCarry);
+	}
+#endif
+
+	// addSubSerial split into one chunk per thread. each chunk is computed with no incoming carry,
+	// then the carries between chunks are applied serially. that pass stops at the first limb which does
+	// not propagate, so it touches only a few limbs per chunk in practice.
+	template<bool SUB>
+	static limb_t addSubParallel(limb_t* r, const limb_t* a, const limb_t* b, size_t n, limb_t nCarry)
+	{
+		size_t nParts = std::min<size_t>(BigThreads::count(), n / (PARALLEL_ADD_LIMBS/4));
+		size_t nChunk = (n + nParts - 1) / nParts;
+		BigScratch::Frame frame;
+		limb_t* pCarryOut = frame.allocate<limb_t>(nParts);
+		BigThreads::parallelFor(nParts, [&](size_t t) {
+			size_t nLo = t*nChunk;
+			size_t nLen = std::min(nChunk, n-nLo);
+			pCarryOut[t] = addSubSerial<SUB>(r+nLo, a+nLo, b+nLo, nLen, 0);
+		});
+
+		for (size_t t=0; t<nParts; t++)
+		{
+			size_t nLo = t*nChunk;
+			size_t nHi = std::min(nLo+nChunk, n);
+			for (size_t i=nLo; (i<nHi) && (nCarry > 0); i++)
+			{
+				r[i] = SUB ? r[i] - 1 : r[i] + 1;
+				nCarry = (r[i] == (SUB ? (limb_t)-1 : 0)) ? 1 : 0;
+			}
+			nCarry |= pCarryOut[t];
+		}
+		return nCarry;
+	}
+
+	/***************************** Division helpers *************************************************/
+
+	// r[0,n) -= a * m. return what has to be subtracted from r[n] (can be LIMB_MAX + 1)
+	static dlimb_t subMul(limb_t* r, const limb_t* a, size_t n, limb_t m)
+	{
+		dlimb_t dCarry = 0;
+		for (size_t i=0; i<n; i++)
+		{
+			dlimb_t dProd = (dlimb_t)a[i] * m + dCarry;
+			limb_t nLow = (limb_t)dProd;
+			dCarry = dProd >> LIMB_BITS;
+			if (r[i] < nLow)
+				dCarry++;
+			r[i] -= nLow;
+		}
+		return dCarry;
+	}
+
+	// Knuth's algorithm D (TAOCP vol.2, 4.3.1). nb >= 2
+	static void divSchool(limb_t* q, limb_t* rem, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+	{
+		// normalize so that the top bit of the divisor is set, then each quotient limb estimate is off by at most 2
+		int nShift = countLeadingZeros(b[nb-1]);
+		BigScratch::Frame frame;
+		limb_t* pNormA = frame.allocate<limb_t>(na+1);
+		limb_t* pNormB = frame.allocate<limb_t>(nb);
+		shiftLeft(pNormB, b, nb, nShift);
+		pNormA[na] = shiftLeft(pNormA, a, na, nShift);
+		const dlimb_t LIMB_MAX = (limb_t)-1;
+		dlimb_t dTop = pNormB[nb-1], dNext = pNormB[nb-2];
+
+		for (size_t j=na-nb+1; j>0; j--)
+		{
+			limb_t* pU = pNormA + j-1;
+			dlimb_t dNum = ((dlimb_t)pU[nb] << LIMB_BITS) | pU[nb-1];
+			dlimb_t dQhat = dNum / dTop;
+			dlimb_t dRhat = dNum % dTop;
+			while ((dQhat > LIMB_MAX) || (dQhat * dNext > ((dRhat << LIMB_BITS) | pU[nb-2])))
+			{
+				dQhat--;
+				dRhat += dTop;
+				if (dRhat > LIMB_MAX)
+					break;
+			}
+
+			dlimb_t dBorrow = subMul(pU, pNormB, nb, (limb_t)dQhat);
+			bool bNegative = (pU[nb] < dBorrow);
+			pU[nb] = (limb_t)(pU[nb] - dBorrow);
+			if (bNegative)
+			{
+				// the estimate was one too large, add the divisor back
+				dQhat--;
+				pU[nb] += add(pU, pU, nb, pNormB, nb);
+			}
+			if (q != nullptr)
+				q[j-1] = (limb_t)dQhat;
+		}
+
+		if (rem != nullptr)
+			shiftRight(rem, pNormA, nb, nShift);
+	}
+
+	// division with a Newton reciprocal. both operands are scaled by B^(k-nb), B = 2^32, where k is 2 limbs more
+	// than the quotient (dropping low limbs of b if it is longer), so that q = floor(a' * floor(B^2k/b') / B^2k)
+	// is at most a few units off. the remainder against the full a and b then corrects it.
+	static void divNewton(limb_t* q, limb_t* rem, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+	{
+		size_t m = na - nb + 1;
+		size_t k = m + 2;
+		BigScratch::Frame frame;
+		limb_t* pQ = frame.allocate<limb_t>(m+1);
+		{
+			// the temporaries of the estimate are given back before the remainder is computed
+			BigScratch::Frame frameEstimate;
+			SignedLimbs sBs = (k >= nb) ? makeSigned(b, nb, k-nb) : makeSigned(b + (nb-k), k, 0);
+
+			// normalize so that the top bit of the divisor is set
+			int nShift = countLeadingZeros(sBs.vMag[k-1]);
+			shiftLeft(sBs.vMag.data(), sBs.vMag.data(), k, nShift);
+			limb_t* pX = frameEstimate.allocate<limb_t>(k+2);
+			reciprocal(pX, sBs.vMag.data(), k);
+			SignedLimbs sX = makeSigned(pX, k+2, 0);
+
+			// x < 2*B^k, so the limbs of a' below B^(k-2) add less than 1 to a'*x/B^2k and are left out:
+			// only a'/B^(k-2) = a*2^nShift/B^(nb-2) is multiplied, shifted from one limb lower for its low bits
+			size_t nFrom = (nb >= 3) ? nb-3 : 0;
+			SignedLimbs sAs = makeSigned(nullptr, 0, na-nFrom+1);
+			sAs.vMag[na-nFrom] = shiftLeft(sAs.vMag.data(), a + nFrom, na-nFrom, nShift);
+			shiftRightLimbs(sAs, nb-2-nFrom);
+			SignedLimbs sQ = mulSigned(sAs, sX);
+			shiftRightLimbs(sQ, k+2);
+			size_t nQ = std::min(m+1, normSize(sQ.vMag.data(), sQ.vMag.size()));
+			std::copy(sQ.vMag.begin(), sQ.vMag.begin()+nQ, pQ);
+			std::fill(pQ+nQ, pQ+m+1, 0);
+		}
+		SignedLimbs sQ = makeSigned(pQ, m+1, 0);
+
+		// r = a - q*b, then step q until 0 <= r < b
+		SignedLimbs sA = makeSigned(a, na, 0);
+		SignedLimbs sB = makeSigned(b, nb, 0);
+		SignedLimbs sOne = makeSigned(nullptr, 0, 0);
+		sOne.vMag.push_back(1);
+		SignedLimbs sR = addSigned(sA, mulSigned(sQ, sB), -1);
+		while (isNegative(sR))
+		{
+			sQ = addSigned(sQ, sOne, -1);
+			sR = addSigned(sR, sB);
+		}
+		while (cmp(sR.vMag.data(), normSize(sR.vMag.data(), sR.vMag.size()), b, nb) >= 0)
+		{
+			sQ = addSigned(sQ, sOne);
+			sR = addSigned(sR, sB, -1);
+		}
+
+		if (q != nullptr)
+		{
+			size_t nQ = std::min(m, normSize(sQ.vMag.data(), sQ.vMag.size()));
+			std::copy(sQ.vMag.begin(), sQ.vMag.begin()+nQ, q);
+			std::fill(q+nQ, q+m, 0);
+		}
+		if (rem != nullptr)
+		{
+			size_t nR = normSize(sR.vMag.data(), sR.vMag.size());
+			std::copy(sR.vMag.begin(), sR.vMag.begin()+nR, rem);
+			std::fill(rem+nR, rem+nb, 0);
+		}
+	}
+
+	// x[0,n+2) = floor(B^2n / b) for b[0,n) with the top bit set. the precision is doubled at each level:
+	// from the reciprocal X0 of the top half, one Newton step X = X0 + X0*(B^2n - b*X0)/B^2n,
+	// then X is stepped until 0 <= B^2n - b*X < b so that every level returns the exact value.
+	// each level gives back its temporaries before returning, so they do not pile up over the levels.
+	static void reciprocal(limb_t* x, const limb_t* b, size_t n)
+	{
+		BigScratch::Frame frame;
+		if (n <= RECIPROCAL_BASECASE)
+		{
+			SignedLimbs sPow = makeSigned(nullptr, 0, 2*n+1);
+			sPow.vMag[2*n] = 1;
+			divSchool(x, nullptr, sPow.vMag.data(), 2*n+1, b, n);
+			return;
+		}
+
+		size_t h = (n+1) / 2;
+		limb_t* pXh = frame.allocate<limb_t>(h+2);
+		reciprocal(pXh, b + (n-h), h);
+
+		// with X0 = Xh * B^(n-h), B^2n - b*X0 = E * B^(n-h) where E = B^(n+h) - b*Xh, so the step adds Xh*E/B^2h
+		// and the low zero limbs of X0 are never multiplied. X is a few units from B^2n/b < 2*B^n, so n+2 limbs hold it.
+		limb_t* pX = frame.allocate<limb_t>(n+2);
+		{
+			BigScratch::Frame frameStep;
+			SignedLimbs sXh = makeSigned(pXh, h+2, 0);
+			SignedLimbs sPowH = makeSigned(nullptr, 0, n+h+1);
+			sPowH.vMag[n+h] = 1;
+			SignedLimbs sE = addSigned(sPowH, mulSigned(makeSigned(b, n, 0), sXh), -1);
+			SignedLimbs sCorr = mulSigned(sXh, sE);
+			shiftRightLimbs(sCorr, 2*h);
+			SignedLimbs sStep = addSigned(makeSigned(pXh, h+2, n-h), sCorr);
+			size_t nX = std::min(n+2, normSize(sStep.vMag.data(), sStep.vMag.size()));
+			std::copy(sStep.vMag.begin(), sStep.vMag.begin()+nX, pX);
+			std::fill(pX+nX, pX+n+2, 0);
+		}
+		SignedLimbs sX = makeSigned(pX, n+2, 0);
+		SignedLimbs sB = makeSigned(b, n, 0);
+		SignedLimbs sPow = makeSigned(nullptr, 0, 2*n+1);
+		sPow.vMag[2*n] = 1;
+
+		SignedLimbs sOne = makeSigned(nullptr, 0, 0);
+		sOne.vMag.push_back(1);
+		SignedLimbs sR = addSigned(sPow, mulSigned(sB, sX), -1);
+		while (isNegative(sR))
+		{
+			sX = addSigned(sX, sOne, -1);
+			sR = addSigned(sR, sB);
+		}
+		while (cmp(sR.vMag.data(), normSize(sR.vMag.data(), sR.vMag.size()), b, n) >= 0)
+		{
+			sX = addSigned(sX, sOne);
+			sR = addSigned(sR, sB, -1);
+		}
+		size_t nX = std::min(n+2, normSize(sX.vMag.data(), sX.vMag.size()));
+		std::copy(sX.vMag.begin(), sX.vMag.begin()+nX, x);
+		std::fill(x+nX, x+n+2, 0);
+	}
+
+	/***************************** Multiplication helpers *******************************************/
+
+	// r = a + b on signed values (nSignB = 1) or r = a - b (nSignB = -1)
+	static SignedLimbs addSigned(const SignedLimbs& a, const SignedLimbs& b, int nSignB = 1)
+	{
+		bool bNegB = (nSignB < 0) ? !b.bNeg : b.bNeg;
+		const SignedLimbs* pBig = &a;
+		const SignedLimbs* pSmall = &b;
+		bool bNegBig = a.bNeg, bNegSmall = bNegB;
+		size_t nBig = normSize(a.vMag.data(), a.vMag.size());
+		size_t nSmall = normSize(b.vMag.data(), b.vMag.size());
+		if (cmp(a.vMag.data(), nBig, b.vMag.data(), nSmall) < 0)
+		{
+			std::swap(pBig, pSmall);
+			std::swap(bNegBig, bNegSmall);
+			std::swap(nBig, nSmall);
+		}
+
+		SignedLimbs sResult;
+		sResult.vMag.assign(nBig + 1, 0);
+		sResult.bNeg = bNegBig;
+		if (bNegBig == bNegSmall)
+			sResult.vMag[nBig] = add(sResult.vMag.data(), pBig->vMag.data(), nBig, pSmall->vMag.data(), nSmall);
+		else
+			sub(sResult.vMag.data(), pBig->vMag.data(), nBig, pSmall->vMag.data(), nSmall);
+		return sResult;
+	}
+
+	// a[0,n) * B^nShiftLimbs as a non-negative SignedLimbs
+	static SignedLimbs makeSigned(const limb_t* a, size_t n, size_t nShiftLimbs)
+	{
+		SignedLimbs sResult;
+		sResult.vMag.assign(nShiftLimbs + n, 0);
+		if (n > 0)
+			std::copy(a, a+n, sResult.vMag.begin() + nShiftLimbs);
+		sResult.bNeg = false;
+		return sResult;
+	}
+
+	// a = a / B^nLimbs, rounding the magnitude down
+	static void shiftRightLimbs(SignedLimbs& a, size_t nLimbs)
+	{
+		if (nLimbs >= a.vMag.size())
+			a.vMag.clear();
+		else
+			a.vMag.erase(a.vMag.begin(), a.vMag.begin() + nLimbs);
+	}
+
+	static bool isNegative(const SignedLimbs& a)
+	{
+		return a.bNeg && (normSize(a.vMag.data(), a.vMag.size()) > 0);
+	}
+
+	// r = a * m for a small unsigned m
+	static SignedLimbs mulSmallSigned(const SignedLimbs& a, limb_t m)
+	{
+		SignedLimbs sResult;
+		sResult.vMag.resize(a.vMag.size() + 1);
+		sResult.vMag.back() = mulSmall(sResult.vMag.data(), a.vMag.data(), a.vMag.size(), m);
+		sResult.bNeg = a.bNeg;
+		return sResult;
+	}
+
+	// a /= d where the division is known to be exact
+	static void divExactSigned(SignedLimbs& a, limb_t d)
+	{
+		divSmall(a.vMag.data(), a.vMag.data(), a.vMag.size(), d);
+	}
+
+	static SignedLimbs mulSigned(const SignedLimbs& a, const SignedLimbs& b)
+	{
+		size_t na = normSize(a.vMag.data(), a.vMag.size());
+		size_t nb = normSize(b.vMag.data(), b.vMag.size());
+		SignedLimbs sResult;
+		sResult.vMag.assign(na + nb, 0);
+		sResult.bNeg = (a.bNeg != b.bNeg);
+		mul(sResult.vMag.data(), a.vMag.data(), na, b.vMag.data(), nb);
+		return sResult;
+	}
+
+	static SignedLimbs sqrSigned(const SignedLimbs& a)
+	{
+		size_t na = normSize(a.vMag.data(), a.vMag.size());
+		SignedLimbs sResult;
+		sResult.vMag.assign(2*na, 0);
+		sResult.bNeg = false;
+		sqr(sResult.vMag.data(), a.vMag.data(), na);
+		return sResult;
+	}
+
+	// r[0,2n) = a * b for operands of the same length n
+	// the split methods are never used below 4 and 9 limbs, where their sub-products would not get smaller
+	static void mulBalanced(limb_t* r, const limb_t* a, const limb_t* b, size_t n)
+	{
+		if ((n < tuning().nKaratsuba) || (n < 4))
+			mulSchool(r, a, n, b, n);
+		else if ((n < tuning().nToom3) || (n < 9))
+			mulKaratsuba(r, a, b, n);
+		else
+			mulToom3(r, a, b, n);
+	}
+
+	// r[0,2n) = a^2 by the same choice of methods as mulBalanced
+	static void sqrBalanced(limb_t* r, const limb_t* a, size_t n)
+	{
+		if ((n < tuning().nKaratsuba) || (n < 4))
+			sqrSchool(r, a, n);
+		else if ((n < tuning().nToom3) || (n < 9))
+			sqrKaratsuba(r, a, n);
+		else
+			sqrToom3(r, a, n);
+	}
+
+	// r[0,na+nb) = a * b where a is at least twice as long as b. multiply b by nb-limb slices of a.
+	static void mulUnbalanced(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+	{
+		std::fill(r, r+na+nb, 0);
+		BigScratch::Frame frame;
+		limb_t* pTmp = frame.allocate<limb_t>(2*nb);
+		for (size_t i=0; i<na; i+=nb)
+		{
+			size_t nSlice = std::min(nb, na-i);
+			mul(pTmp, a+i, nSlice, b, nb);
+			add(r+i, r+i, na+nb-i, pTmp, nSlice+nb);
+		}
+	}
+
+	// r[0,na+nb) = a * b with a cut into one slice per thread. the slice products are computed in parallel
+	// (serially inside each thread) and summed at their offsets.
+	static void mulBlocks(limb_t* r, const limb_t* a, size_t na, const limb_t* b, size_t nb)
+	{
+		size_t nParts = std::min(BigThreads::count(), std::max<size_t>(na / (PARALLEL_MUL_LIMBS/4), 1));
+		size_t nSlice = (na + nParts - 1) / nParts;
+		BigScratch::Frame frame;
+		limb_t* pProducts = frame.allocate<limb_t>(nParts * (nSlice + nb));
+		BigThreads::parallelFor(nParts, [&](size_t t) {
+			size_t nLo = t*nSlice;
+			size_t nLen = std::min(nSlice, na-nLo);
+			mul(pProducts + t*(nSlice+nb), a+nLo, nLen, b, nb);
+		});
+
+		std::fill(r, r+na+nb, 0);
+		for (size_t t=0; t<nParts; t++)
+		{
+			size_t nLo = t*nSlice;
+			size_t nLen = std::min(nSlice, na-nLo);
+			add(r+nLo, r+nLo, na+nb-nLo, pProducts + t*(nSlice+nb), nLen+nb);
+		}
+	}
+
+	// Karatsuba: a*b = z2*X^2 + (z1-z2-z0)*X + z0 where z1 = (a0+a1)*(b0+b1)
+	static void mulKaratsuba(limb_t* r, const limb_t* a, const limb_t* b, size_t n)
+	{
+		size_t h = n/2, hh = n-h;
+
+		// z0 and z2 go directly to the low and high halves of r
+		mulBalanced(r, a, b, h);
+		mulBalanced(r+2*h, a+h, b+h, hh);
+
+		BigScratch::Frame frame;
+		limb_t* pSumA = frame.allocate<limb_t>(hh+1);
+		limb_t* pSumB = frame.allocate<limb_t>(hh+1);
+		limb_t* pZ1 = frame.allocate<limb_t>(2*hh+2);
+		pSumA[hh] = add(pSumA, a+h, hh, a, h);
+		pSumB[hh] = add(pSumB, b+h, hh, b, h);
+		mulBalanced(pZ1, pSumA, pSumB, hh+1);
+		sub(pZ1, pZ1, 2*hh+2, r, 2*h);
+		sub(pZ1, pZ1, 2*hh+2, r+2*h, 2*hh);
+
+		add(r+h, r+h, 2*n-h, pZ1, normSize(pZ1, 2*hh+2));
+	}
+
+	// Karatsuba squaring: a^2 = z2*X^2 + (z0+z2-(a1-a0)^2)*X + z0. the difference needs no carry limb,
+	// and its square is the same whatever the sign.
+	static void sqrKaratsuba(limb_t* r, const limb_t* a, size_t n)
+	{
+		size_t h = n/2, hh = n-h;
+
+		sqrBalanced(r, a, h);
+		sqrBalanced(r+2*h, a+h, hh);
+
+		BigScratch::Frame frame;
+		limb_t* pDiff = frame.allocate<limb_t>(hh);
+		limb_t* pD2 = frame.allocate<limb_t>(2*hh);
+		limb_t* pMid = frame.allocate<limb_t>(2*hh+1);
+		if (cmp(a+h, normSize(a+h, hh), a, normSize(a, h)) >= 0)
+			sub(pDiff, a+h, hh, a, h);
+		else
+		{
+			std::copy(a, a+h, pDiff);
+			std::fill(pDiff+h, pDiff+hh, 0);
+			sub(pDiff, pDiff, hh, a+h, hh);
+		}
+		sqrBalanced(pD2, pDiff, hh);
+		pMid[2*hh] = add(pMid, r+2*h, 2*hh, r, 2*h);
+		sub(pMid, pMid, 2*hh+1, pD2, 2*hh);
+
+		add(r+h, r+h, 2*n-h, pMid, normSize(pMid, 2*hh+1));
+	}
+
+	// Toom-3 with the evaluation points 0, 1, -1, -2, inf and Bodrato's interpolation sequence
+	static void mulToom3(limb_t* r, const limb_t* a, const limb_t* b, size_t n)
+	{
+		size_t k = (n+2)/3;
+		size_t nTop = n - 2*k;
+
+		// evaluate the polynomials of 3 parts
+		BigScratch::Frame frame;
+		SignedLimbs sA[5], sB[5];
+		evalToom3(sA, a, k, nTop);
+		evalToom3(sB, b, k, nTop);
+
+		SignedLimbs sR[5];
+		for (size_t i=0; i<5; i++)
+			sR[i] = mulSigned(sA[i], sB[i]);
+		interpolateToom3(r, n, k, sR);
+	}
+
+	// r[0,2n) from the values sR of the product polynomial at 0, 1, -1, -2, inf with parts of k limbs
+	static void interpolateToom3(limb_t* r, size_t n, size_t k, SignedLimbs* sR)
+	{
+		SignedLimbs& sR0 = sR[0];
+		SignedLimbs& sR1 = sR[1];
+		SignedLimbs& sRm1 = sR[2];
+		SignedLimbs& sRm2 = sR[3];
+		SignedLimbs& sRinf = sR[4];
+
+		SignedLimbs sR3 = addSigned(sRm2, sR1, -1);
+		divExactSigned(sR3, 3);
+		SignedLimbs sR1n = addSigned(sR1, sRm1, -1);
+		divExactSigned(sR1n, 2);
+		SignedLimbs sR2 = addSigned(sRm1, sR0, -1);
+		sR3 = addSigned(sR2, sR3, -1);
+		divExactSigned(sR3, 2);
+		sR3 = addSigned(sR3, mulSmallSigned(sRinf, 2));
+		sR2 = addSigned(addSigned(sR2, sR1n), sRinf, -1);
+		sR1n = addSigned(sR1n, sR3, -1);
+
+		// recompose. all the coefficients are non-negative here
+		std::fill(r, r+2*n, 0);
+		const SignedLimbs* pCoef[5] = {&sR0, &sR1n, &sR2, &sR3, &sRinf};
+		for (size_t i=0; i<5; i++)
+		{
+			size_t nOffset = i*k;
+			size_t nLen = normSize(pCoef[i]->vMag.data(), pCoef[i]->vMag.size());
+			if (nLen > 0)
+				add(r+nOffset, r+nOffset, 2*n-nOffset, pCoef[i]->vMag.data(), nLen);
+		}
+	}
+
+	// Toom-3 squaring: the same evaluation points, with each of the 5 values squared
+	static void sqrToom3(limb_t* r, const limb_t* a, size_t n)
+	{
+		size_t k = (n+2)/3;
+		size_t nTop = n - 2*k;
+
+		BigScratch::Frame frame;
+		SignedLimbs sA[5], sR[5];
+		evalToom3(sA, a, k, nTop);
+		for (size_t i=0; i<5; i++)
+			sR[i] = sqrSigned(sA[i]);
+		interpolateToom3(r, n, k, sR);
+	}
+
+	// p(0), p(1), p(-1), p(-2), p(inf) of p(x) = a0 + a1*x + a2*x^2, where a0 and a1 are k limbs and a2 is nTop limbs
+	static void evalToom3(SignedLimbs* sP, const limb_t* a, size_t k, size_t nTop)
+	{
+		SignedLimbs sA0 = makeSigned(a, k, 0);
+		SignedLimbs sA1 = makeSigned(a+k, k, 0);
+		SignedLimbs sA2 = makeSigned(a+2*k, nTop, 0);
+
+		SignedLimbs sTmp = addSigned(sA0, sA2);
+		sP[0] = sA0;
+		sP[1] = addSigned(sTmp, sA1);
+		sP[2] = addSigned(sTmp, sA1, -1);
+		sP[3] = addSigned(mulSmallSigned(addSigned(sP[2], sA2), 2), sA0, -1);
+		sP[4] = sA2;
+	}
+
+	// average time of a balanced n-limb product with the current tuning
+	static double timeMul(size_t n)
+	{
+		std::vector<limb_t> vA(n), vB(n), vR(2*n);
+		uint32_t nSeed = 2463534242u;
+		for (size_t i=0; i<n; i++)
+		{
+			nSeed ^= nSeed << 13; nSeed ^= nSeed >> 17; nSeed ^= nSeed << 5;
+			vA[i] = nSeed;
+			nSeed ^= nSeed << 13; nSeed ^= nSeed >> 17; nSeed ^= nSeed << 5;
+			vB[i] = nSeed;
+		}
+
+		// repeat until the run is long enough to time reliably
+		int nRepeat = 0;
+		std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+		double dElapsed = 0;
+		do
+		{
+			mul(vR.data(), vA.data(), n, vB.data(), n);
+			nRepeat++;
+			dElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+		} while (dElapsed < 0.02);
+		return dElapsed / nRepeat;
+	}
+};
+
+#endif
@@ -0,0 +1,238 @@
+/* BigMontgomery.h
+**
+** Modular arithmetic in Montgomery representation and modular exponentiation on top of it.
+**
+** For an odd modulus N of n limbs and R = 2^(32n), a residue x is held as x*R mod N. The product of two such
+** values is reduced by REDC, which only needs multiplications by the precomputed -1/N mod 2^32 and shifts,
+** so no division happens inside the exponentiation loop. Squarings use BigKernels::sqr.
+** powmod scans the exponent with a sliding window of odd powers. Even moduli fall back to BigInt division.
+**
+** compiled and tested with g++ 12.2.0
+**
+** MIT License
+** Copyright (c) 2017 636F57@GitHub
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE
+*/
+
+#ifndef BIGMONTGOMERY_H
+#define BIGMONTGOMERY_H
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include "BigInt.h"
+
+class BigMontgomery
+{
+public:
+	typedef BigKernels::limb_t limb_t;
+
+private:
+	BigInt biMod;
+	std::vector<limb_t> vN;    // modulus, n limbs
+	std::vector<limb_t> vR2;   // R^2 mod N, n limbs
+	std::vector<limb_t> vTmp;  // 2n+1 limbs of scratch for the products
+	limb_t nInv;               // -1/N mod 2^32
+
+	// r[0,n) = t * R^-1 mod N. t has 2n+1 limbs (the top one zero) and is destroyed.
+	void redc(limb_t* r, limb_t* t) const
+	{
+		size_t n = vN.size();
+		for (size_t i=0; i<n; i++)
+		{
+			limb_t m = t[i] * nInv;
+			limb_t nCarry = BigKernels::addMul(t+i, vN.data(), n, m);
+			BigKernels::add(t+i+n, t+i+n, n+1-i, &nCarry, 1);
+		}
+		// t[n,2n] < 2N here
+		if ((t[2*n] != 0) || (BigKernels::cmp(t+n, n, vN.data(), n) >= 0))
+			BigKernels::sub(t+n, t+n, n+1, vN.data(), n);
+		std::copy(t+n, t+2*n, r);
+	}
+
+	// sliding window size for an exponent of nBits bits
+	static int windowBits(size_t nBits)
+	{
+		if (nBits <= 24)
+			return 1;
+		if (nBits <= 80)
+			return 3;
+		if (nBits <= 240)
+			return 4;
+		if (nBits <= 768)
+			return 5;
+		return 6;
+	}
+
+	static bool testBit(const std::vector<limb_t>& vLimbs, size_t nBit)
+	{
+		return (vLimbs[nBit / BigKernels::LIMB_BITS] >> (nBit % BigKernels::LIMB_BITS)) & 1;
+	}
+
+	// base^exp mod m by square-and-multiply with BigInt division, for even moduli
+	static BigInt powmodPlain(BigInt biBase, const BigInt& biExp, const BigInt& biModulus)
+	{
+		BigInt biResult(1);
+		const std::vector<limb_t>& vExp = biExp.limbs();
+		for (size_t i=vExp.size()*BigKernels::LIMB_BITS; i>0; i--)
+		{
+			biResult = (biResult * biResult) % biModulus;
+			if (testBit(vExp, i-1))
+				biResult = (biResult * biBase) % biModulus;
+		}
+		return biResult % biModulus;
+	}
+
+public:
+	// biModulus must be odd and greater than 1. throw std::domain_error otherwise.
+	explicit BigMontgomery(const BigInt& biModulus)
+	{
+		if ((biModulus.sign() <= 0) || ((biModulus.limbs()[0] & 1) == 0) || (biModulus == BigInt(1)))
+			throw std::domain_error("BigMontgomery: the modulus must be odd and greater than 1");
+		biMod = biModulus;
+		vN = biModulus.limbs();
+		size_t n = vN.size();
+		vTmp.resize(2*n+1);
+
+		// 1/N mod 2^32 by Newton iteration, each step doubles the correct bits (N*N = 1 mod 8 to start)
+		limb_t nInvN = vN[0];
+		for (int i=0; i<5; i++)
+			nInvN *= 2 - vN[0]*nInvN;
+		nInv = (limb_t)0 - nInvN;
+
+		std::vector<limb_t> vR2Full(2*n+1, 0);
+		vR2Full[2*n] = 1;
+		vR2 = (BigInt::fromLimbs(vR2Full) % biModulus).limbs();
+		vR2.resize(n, 0);
+	}
+
+	size_t size() const { return vN.size(); }
+	const BigInt& modulus() const { return biMod; }
+
+	// r[0,n) = a * b * R^-1 mod N
+	void mul(limb_t* r, const limb_t* a, const limb_t* b)
+	{
+		size_t n = vN.size();
+		BigKernels::mul(vTmp.data(), a, n, b, n);
+		vTmp[2*n] = 0;
+		redc(r, vTmp.data());
+	}
+
+	// r[0,n) = a * a * R^-1 mod N
+	void sqr(limb_t* r, const limb_t* a)
+	{
+		size_t n = vN.size();
+		BigKernels::sqr(vTmp.data(), a, n);
+		vTmp[2*n] = 0;
+		redc(r, vTmp.data());
+	}
+
+	// x * R mod N as n limbs
+	std::vector<limb_t> toMont(const BigInt& x)
+	{
+		BigInt biReduced = x % biMod;
+		if (biReduced.isNegative())
+			biReduced += biMod;
+		std::vector<limb_t> vX = biReduced.limbs();
+		vX.resize(vN.size(), 0);
+		std::vector<limb_t> vResult(vN.size());
+		mul(vResult.data(), vX.data(), vR2.data());
+		return vResult;
+	}
+
+	BigInt fromMont(const std::vector<limb_t>& vX)
+	{
+		size_t n = vN.size();
+		std::fill(vTmp.begin(), vTmp.end(), 0);
+		std::copy(vX.begin(), vX.begin()+n, vTmp.begin());
+		std::vector<limb_t> vResult(n);
+		redc(vResult.data(), vTmp.data());
+		return BigInt::fromLimbs(vResult);
+	}
+
+	// base^exp mod N for exp >= 0, in [0,N)
+	BigInt pow(const BigInt& biBase, const BigInt& biExp)
+	{
+		if (biExp.isNegative())
+			throw std::domain_error("BigMontgomery: negative exponent");
+		size_t n = vN.size();
+		const std::vector<limb_t>& vExp = biExp.limbs();
+		size_t nBits = BigKernels::normSize(vExp.data(), vExp.size()) * BigKernels::LIMB_BITS;
+		while ((nBits > 0) && !testBit(vExp, nBits-1))
+			nBits--;
+		if (nBits == 0)
+			return BigInt(1) % biMod;
+
+		// odd powers base^1, base^3, ..., base^(2^w - 1)
+		int w = windowBits(nBits);
+		std::vector<std::vector<limb_t>> vTable((size_t)1 << (w-1));
+		vTable[0] = toMont(biBase);
+		std::vector<limb_t> vBase2(n);
+		sqr(vBase2.data(), vTable[0].data());
+		for (size_t i=1; i<vTable.size(); i++)
+		{
+			vTable[i].resize(n);
+			mul(vTable[i].data(), vTable[i-1].data(), vBase2.data());
+		}
+
+		// scan from the top bit. a window starts at a set bit and ends at the lowest set bit within w bits
+		std::vector<limb_t> vAcc, vNext(n);
+		size_t i = nBits;
+		while (i > 0)
+		{
+			if (!testBit(vExp, i-1))
+			{
+				sqr(vNext.data(), vAcc.data());
+				vAcc.swap(vNext);
+				i--;
+				continue;
+			}
+			size_t nLow = (i >= (size_t)w) ? i - w : 0;
+			while (!testBit(vExp, nLow))
+				nLow++;
+			size_t nValue = 0;
+			for (size_t j=i; j>nLow; j--)
+				nValue = (nValue << 1) | (testBit(vExp, j-1) ? 1 : 0);
+
+			if (vAcc.empty())
+			{
+				vAcc = vTable[nValue >> 1];
+			}
+			else
+			{
+				for (size_t j=nLow; j<i; j++)
+				{
+					sqr(vNext.data(), vAcc.data());
+					vAcc.swap(vNext);
+				}
+				mul(vNext.data(), vAcc.data(), vTable[nValue >> 1].data());
+				vAcc.swap(vNext);
+			}
+			i = nLow;
+		}
+		return fromMont(vAcc);
+	}
+
+	// base^exp mod m for exp >= 0 and m > 0, in [0,m). Montgomery for odd m, plain reduction for even m.
+	// throw std::domain_error for a negative exponent or a non-positive modulus.
+	static BigInt powmod(const BigInt& biBase, const BigInt& biExp, const BigInt& biModulus)
+	{
+		if (biModulus.sign() <= 0)
+			throw std::domain_error("BigMontgomery: the modulus must be positive");
+		if (biExp.isNegative())
+			throw std::domain_error("BigMontgomery: negative exponent");
+		if (biModulus == BigInt(1))
+			return BigInt(0);
+		if ((biModulus.limbs()[0] & 1) == 0)
+		{
+			BigInt biReduced = biBase % biModulus;
+			if (biReduced.isNegative())
+				biReduced += biModulus;
+			return powmodPlain(biReduced, biExp, biModulus);
+		}
+		BigMontgomery montMod(biModulus);
+		return montMod.pow(biBase, biExp);
+	}
+};
+
+#endif
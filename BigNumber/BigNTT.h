@@ -0,0 +1,251 @@
+/* BigNTT.h
+**
+** Big integer multiplication by number-theoretic transform, used by BigKernels::mul for huge operands.
+**
+** The 32-bit limbs are convolved modulo three NTT-friendly primes and the exact coefficients are recovered
+** with the Chinese remainder theorem (Garner's method), so no floating-point rounding is involved.
+** Each coefficient is below min(na,nb) * 2^64, which fits under the product of the primes (about 2^86)
+** as long as the transform length is at most 2^23, i.e. na+nb <= MAX_LIMBS.
+** Long transforms and the recombination are split over BigThreads::count() threads.
+**
+** compiled and tested with g++ 12.2.0 (uses unsigned __int128)
+**
+** MIT License
+** Copyright (c) 2017 636F57@GitHub
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE
+*/
+
+#ifndef BIGNTT_H
+#define BIGNTT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+#include "BigThreads.h"
+#include "BigScratch.h"
+
+class BigNTT
+{
+public:
+	static const uint32_t P1 = 998244353;  // 119 * 2^23 + 1
+	static const uint32_t P2 = 167772161;  // 5 * 2^25 + 1
+	static const uint32_t P3 = 469762049;  // 7 * 2^26 + 1
+	static const uint32_t PRIMITIVE_ROOT = 3;  // shared by all three primes
+	static const size_t MAX_LIMBS = (size_t)1 << 23;  // limited by the 2-adic order of P1
+
+	// r[0,na+nb) = a * b. na+nb must not exceed MAX_LIMBS.
+	static void mul(uint32_t* r, const uint32_t* a, size_t na, const uint32_t* b, size_t nb)
+	{
+		size_t nLen = 1;
+		while (nLen < na+nb-1)
+			nLen <<= 1;
+		size_t nParts = partsFor(nLen);
+
+		BigScratch::Frame frame;
+		uint32_t* pC1 = frame.allocate<uint32_t>(nLen);
+		uint32_t* pC2 = frame.allocate<uint32_t>(nLen);
+		uint32_t* pC3 = frame.allocate<uint32_t>(nLen);
+		uint32_t* pTmp = (a == b) && (na == nb) ? nullptr : frame.allocate<uint32_t>(nLen);
+		convolve<P1>(pC1, pTmp, a, na, b, nb, nLen, nParts);
+		convolve<P2>(pC2, pTmp, a, na, b, nb, nLen, nParts);
+		convolve<P3>(pC3, pTmp, a, na, b, nb, nLen, nParts);
+
+		// recover the coefficients in chunks, each with its own carry, then pass the carries between the chunks
+		size_t nOut = na+nb;
+		size_t nChunk = (nOut + nParts - 1) / nParts;
+		unsigned __int128* pCarryOut = frame.allocate<unsigned __int128>(nParts);
+		BigThreads::parallelFor(nParts, [&](size_t t) {
+			size_t nLo = std::min(t*nChunk, nOut);
+			size_t nHi = std::min(nLo+nChunk, nOut);
+			pCarryOut[t] = recombine(r, pC1, pC2, pC3, nLo, nHi, nOut-1);
+		});
+		unsigned __int128 uCarry = 0;
+		for (size_t t=0; t<nParts; t++)
+		{
+			size_t nLo = std::min(t*nChunk, nOut);
+			size_t nHi = std::min(nLo+nChunk, nOut);
+			for (size_t i=nLo; (i<nHi) && (uCarry > 0); i++)
+			{
+				uCarry += r[i];
+				r[i] = (uint32_t)uCarry;
+				uCarry >>= 32;
+			}
+			uCarry += pCarryOut[t];
+		}
+	}
+
+	// r[0,2n) = a^2. 2n must not exceed MAX_LIMBS. the operand is transformed once per prime instead of twice.
+	static void sqr(uint32_t* r, const uint32_t* a, size_t n)
+	{
+		mul(r, a, n, a, n);
+	}
+
+private:
+	static const size_t PARALLEL_LEN = (size_t)1 << 16;  // transforms from this length are split over threads
+	static const size_t MIN_SEGMENT = (size_t)1 << 12;
+
+	// number of parts (a power of 2) the work on nLen points is split into
+	static size_t partsFor(size_t nLen)
+	{
+		if (nLen < PARALLEL_LEN)
+			return 1;
+		size_t nParts = 1;
+		while ((2*nParts <= BigThreads::count()) && (nLen / (2*nParts) >= MIN_SEGMENT))
+			nParts <<= 1;
+		return nParts;
+	}
+
+	template<uint32_t P>
+	static uint64_t powMod(uint64_t x, uint64_t e)
+	{
+		uint64_t y = 1;
+		x %= P;
+		while (e > 0)
+		{
+			if (e & 1)
+				y = y * x % P;
+			x = x * x % P;
+			e >>= 1;
+		}
+		return y;
+	}
+
+	// r[nLo,nHi) = coefficients x = t1 + t2*P1 + t3*P1*P2 (Garner) with the carries from nLo. return the carry out.
+	// coefficients above nLast are zero.
+	static unsigned __int128 recombine(uint32_t* r, const uint32_t* c1, const uint32_t* c2, const uint32_t* c3, size_t nLo, size_t nHi, size_t nLast)
+	{
+		const uint64_t INV_P1_MOD_P2 = powMod<P2>(P1 % P2, P2-2);
+		const uint64_t INV_P1P2_MOD_P3 = powMod<P3>((uint64_t)P1 * P2 % P3, P3-2);
+		const uint64_t P1_MOD_P3 = P1 % P3;
+		unsigned __int128 uCarry = 0;
+		for (size_t i=nLo; i<nHi; i++)
+		{
+			if (i < nLast)
+			{
+				uint64_t t1 = c1[i];
+				uint64_t t2 = (c2[i] + P2 - t1 % P2) % P2 * INV_P1_MOD_P2 % P2;
+				uint64_t t3 = (c3[i] + 2*(uint64_t)P3 - t1 % P3 - t2 * P1_MOD_P3 % P3) % P3 * INV_P1P2_MOD_P3 % P3;
+				uCarry += t1 + (unsigned __int128)t2 * P1 + (unsigned __int128)t3 * P1 * P2;
+			}
+			r[i] = (uint32_t)uCarry;
+			uCarry >>= 32;
+		}
+		return uCarry;
+	}
+
+	// c[0,nLen) = cyclic convolution of a and b modulo P with nLen points (a power of 2).
+	// pTmp holds the transform of b. it is null for a square (same operand), which needs only one forward transform.
+	template<uint32_t P>
+	static void convolve(uint32_t* c, uint32_t* pTmp, const uint32_t* a, size_t na, const uint32_t* b, size_t nb, size_t nLen, size_t nParts)
+	{
+		for (size_t i=0; i<na; i++)
+			c[i] = a[i] % P;
+		std::fill(c+na, c+nLen, 0);
+		transform<P>(c, nLen, false, nParts);
+		const uint32_t* pOther = c;
+		if (pTmp != nullptr)
+		{
+			for (size_t i=0; i<nb; i++)
+				pTmp[i] = b[i] % P;
+			std::fill(pTmp+nb, pTmp+nLen, 0);
+			transform<P>(pTmp, nLen, false, nParts);
+			pOther = pTmp;
+		}
+
+		size_t nSeg = nLen / nParts;
+		BigThreads::parallelFor(nParts, [&](size_t t) {
+			for (size_t i=t*nSeg; i<(t+1)*nSeg; i++)
+				c[i] = (uint64_t)c[i] * pOther[i] % P;
+		});
+		transform<P>(c, nLen, true, nParts);
+	}
+
+	// in-place iterative radix-2 NTT. the inverse includes the division by the length.
+	// P is a template parameter so that the modulo operations compile to multiplications.
+	// with nParts > 1, the array is cut into nParts segments: the levels whose butterflies stay inside a segment
+	// run as independent sub-transforms, and the top log2(nParts) levels split their butterflies by index.
+	template<uint32_t P>
+	static void transform(uint32_t* pA, size_t n, bool bInverse, size_t nParts)
+	{
+		size_t nSeg = n / nParts;
+		int nBits = 0;
+		while (((size_t)1 << nBits) < n)
+			nBits++;
+
+		// bit-reversal permutation. each pair is swapped by the part owning its smaller index
+		BigThreads::parallelFor(nParts, [&](size_t t) {
+			size_t j = 0;
+			for (int k=0; k<nBits; k++)
+				j |= ((t*nSeg >> k) & 1) << (nBits-1-k);
+			for (size_t i=t*nSeg; i<(t+1)*nSeg; i++)
+			{
+				if (i < j)
+					std::swap(pA[i], pA[j]);
+				size_t nBit = n >> 1;
+				for (; j & nBit; nBit >>= 1)
+					j ^= nBit;
+				j ^= nBit;
+			}
+		});
+
+		BigThreads::parallelFor(nParts, [&](size_t t) {
+			for (size_t nHalf=1; nHalf<nSeg; nHalf<<=1)
+				butterflies<P>(pA + t*nSeg, nSeg, nHalf, 0, nHalf, levelRoot<P>(nHalf, bInverse));
+		});
+		for (size_t nHalf=nSeg; nHalf<n; nHalf<<=1)
+		{
+			uint64_t w = levelRoot<P>(nHalf, bInverse);
+			size_t nStep = nHalf / nParts;
+			BigThreads::parallelFor(nParts, [&](size_t t) {
+				butterflies<P>(pA, n, nHalf, t*nStep, (t+1)*nStep, w);
+			});
+		}
+
+		if (bInverse)
+		{
+			uint64_t nInv = powMod<P>(n, P-2);
+			BigThreads::parallelFor(nParts, [&](size_t t) {
+				for (size_t i=t*nSeg; i<(t+1)*nSeg; i++)
+					pA[i] = (uint64_t)pA[i] * nInv % P;
+			});
+		}
+	}
+
+	// primitive (2*nHalf)-th root of unity (or its inverse)
+	template<uint32_t P>
+	static uint64_t levelRoot(size_t nHalf, bool bInverse)
+	{
+		uint64_t w = powMod<P>(PRIMITIVE_ROOT, (P-1) / (2*nHalf));
+		return bInverse ? powMod<P>(w, P-2) : w;
+	}
+
+	// butterflies with the indices [nJ0,nJ1) of every block of 2*nHalf points in pA[0,n)
+	template<uint32_t P>
+	static void butterflies(uint32_t* pA, size_t n, size_t nHalf, size_t nJ0, size_t nJ1, uint64_t w)
+	{
+		BigScratch::Frame frame;
+		uint32_t* pRoots = frame.allocate<uint32_t>(nJ1-nJ0);
+		uint64_t wj = powMod<P>(w, nJ0);
+		for (size_t j=nJ0; j<nJ1; j++)
+		{
+			pRoots[j-nJ0] = (uint32_t)wj;
+			wj = wj * w % P;
+		}
+
+		for (size_t i=0; i<n; i+=2*nHalf)
+		{
+			uint32_t* pLo = pA + i;
+			uint32_t* pHi = pA + i + nHalf;
+			for (size_t j=nJ0; j<nJ1; j++)
+			{
+				uint32_t u = pLo[j];
+				uint32_t v = (uint64_t)pHi[j] * pRoots[j-nJ0] % P;
+				pLo[j] = (u+v >= P) ? u+v-P : u+v;
+				pHi[j] = (u >= v) ? u-v : u+P-v;
+			}
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,225 @@
+/* BigScratch.h
+**
+** Scratch arena for the temporary buffers of the BigNumber kernels.
+**
+** The arena is a stack of large blocks with a bump pointer. A kernel opens a Frame, takes its temporaries from
+** the arena and gives all of them back at once when the frame closes, so the blocks are reused from one
+** operation to the next: once they have grown to the working size, the kernels do no malloc at all.
+** The blocks are only freed by trim() or when the arena is destroyed.
+**
+** Each thread has its own default arena. Another arena can be installed for a thread with a Scope,
+** e.g. to size it in advance or to read its peak usage for one calculation:
+**     BigScratch scratch(1 << 20);
+**     { BigScratch::Scope scope(scratch); x = a * b; }
+**     std::cout << scratch.peak() << " bytes of scratch\n";
+** Worker threads of the parallel kernels use their own default arenas.
+**
+** compiled and tested with g++ 12.2.0
+**
+** MIT License
+** Copyright (c) 2017 636F57@GitHub
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE
+*/
+
+#ifndef BIGSCRATCH_H
+#define BIGSCRATCH_H
+
+#include <cstddef>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+class BigScratch
+{
+private:
+	static const size_t ALIGNMENT = 64;  // every allocation starts on its own cache line
+	static const size_t MIN_BLOCK = (size_t)1 << 16;
+
+	struct Block
+	{
+		std::unique_ptr<unsigned char[]> pData;
+		size_t nSize;
+	};
+
+	std::vector<Block> vBlocks;
+	size_t nBlock = 0;      // block in use
+	size_t nOffset = 0;     // bytes used in the block in use
+	size_t nBefore = 0;     // total size of the blocks before it
+	size_t nPeak = 0;
+
+	static BigScratch*& currentSetting()
+	{
+		static thread_local BigScratch scratchDefault;
+		static thread_local BigScratch* pCurrent = &scratchDefault;
+		return pCurrent;
+	}
+
+	// move to the next block, making it at least nBytes long. the blocks after the one in use hold no data,
+	// so one which is too small can be replaced.
+	void nextBlock(size_t nBytes)
+	{
+		if (!vBlocks.empty())
+		{
+			nBefore += vBlocks[nBlock].nSize;
+			nBlock++;
+		}
+		if ((nBlock < vBlocks.size()) && (vBlocks[nBlock].nSize >= nBytes))
+		{
+			nOffset = 0;
+			return;
+		}
+		size_t nSize = std::max(std::max(nBytes, (size_t)MIN_BLOCK), capacity());
+		Block blockNew = {std::unique_ptr<unsigned char[]>(new unsigned char[nSize + ALIGNMENT]), nSize};
+		if (nBlock < vBlocks.size())
+			vBlocks[nBlock] = std::move(blockNew);
+		else
+			vBlocks.push_back(std::move(blockNew));
+		nOffset = 0;
+	}
+
+public:
+	BigScratch(){}
+
+	// reserve nBytes up front so that no allocation is needed up to that usage
+	explicit BigScratch(size_t nBytes)
+	{
+		nextBlock(nBytes);
+	}
+
+	BigScratch(const BigScratch&) = delete;
+	BigScratch& operator=(const BigScratch&) = delete;
+
+	// nBytes of uninitialized memory aligned to 64 bytes, valid until the enclosing frame is released
+	void* allocate(size_t nBytes)
+	{
+		nBytes = (nBytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+		if (vBlocks.empty() || (nOffset + nBytes > vBlocks[nBlock].nSize))
+			nextBlock(nBytes);
+		unsigned char* pBase = vBlocks[nBlock].pData.get();
+		pBase += (ALIGNMENT - (size_t)pBase % ALIGNMENT) % ALIGNMENT;
+		void* p = pBase + nOffset;
+		nOffset += nBytes;
+		nPeak = std::max(nPeak, used());
+		return p;
+	}
+
+	template<typename T>
+	T* allocate(size_t n)
+	{
+		return (T*)allocate(n * sizeof(T));
+	}
+
+	// position to go back to with release(). includes the unused tails of the blocks left behind.
+	size_t used() const { return nBefore + nOffset; }
+
+	// free everything allocated since used() returned nMark
+	void release(size_t nMark)
+	{
+		while ((nBlock > 0) && (nBefore > nMark))
+		{
+			nBlock--;
+			nBefore -= vBlocks[nBlock].nSize;
+		}
+		nOffset = nMark - nBefore;
+	}
+
+	// the highest used() so far, in bytes
+	size_t peak() const { return nPeak; }
+	void resetPeak() { nPeak = used(); }
+
+	// free the blocks which hold no data, e.g. after a calculation much larger than the ones which follow
+	void trim()
+	{
+		if (used() == 0)
+		{
+			vBlocks.clear();
+			nBlock = 0;
+			nOffset = 0;
+			nBefore = 0;
+		}
+		else
+			vBlocks.resize(nBlock + 1);
+	}
+
+	size_t capacity() const
+	{
+		size_t nTotal = 0;
+		for (size_t i=0; i<vBlocks.size(); i++)
+			nTotal += vBlocks[i].nSize;
+		return nTotal;
+	}
+
+	// arena used by the kernels on this thread
+	static BigScratch& current()
+	{
+		return *currentSetting();
+	}
+
+	// install an arena for this thread until the end of the scope
+	class Scope
+	{
+	private:
+		BigScratch* pPrev;
+
+	public:
+		explicit Scope(BigScratch& scratch) : pPrev(currentSetting())
+		{
+			currentSetting() = &scratch;
+		}
+		~Scope()
+		{
+			currentSetting() = pPrev;
+		}
+		Scope(const Scope&) = delete;
+		Scope& operator=(const Scope&) = delete;
+	};
+
+	// everything taken from the current arena while the frame is open is released when it closes
+	class Frame
+	{
+	private:
+		BigScratch& scratch;
+		size_t nMark;
+
+	public:
+		Frame() : scratch(current()), nMark(scratch.used()) {}
+		~Frame()
+		{
+			scratch.release(nMark);
+		}
+		Frame(const Frame&) = delete;
+		Frame& operator=(const Frame&) = delete;
+
+		template<typename T>
+		T* allocate(size_t n)
+		{
+			return scratch.allocate<T>(n);
+		}
+	};
+
+	// std::allocator for containers living inside a frame: memory comes from the current arena and
+	// deallocation does nothing, the frame gives it back.
+	template<typename T>
+	struct Allocator
+	{
+		typedef T value_type;
+		BigScratch* pScratch;
+
+		Allocator() : pScratch(&current()) {}
+		template<typename U>
+		Allocator(const Allocator<U>& other) : pScratch(other.pScratch) {}
+
+		T* allocate(size_t n) { return pScratch->allocate<T>(n); }
+		void deallocate(T*, size_t) {}
+
+		template<typename U>
+		bool operator==(const Allocator<U>& other) const { return pScratch == other.pScratch; }
+		template<typename U>
+		bool operator!=(const Allocator<U>& other) const { return pScratch != other.pScratch; }
+	};
+
+	template<typename T>
+	using Vector = std::vector<T, Allocator<T>>;
+};
+
+#endif
@@ -0,0 +1,198 @@
+/* BigThreads.h
+**
+** Thread settings and the parallel loop used by the BigNumber kernels for very large operands.
+**
+** The number of threads defaults to the number of hardware threads and can be changed with setCount()
+** (set it before starting the calculations). Code running inside a parallel loop sees count() == 1,
+** so nested kernels stay serial instead of oversubscribing the machine.
+** The loops run on a pool of threads started by the first parallel loop and kept waiting for the next ones.
+** All the parallel kernels do the same integer operations as their serial versions, so the results are
+** bit-identical whatever the thread count.
+**
+** compiled and tested with g++ 12.2.0 (compile with -pthread)
+**
+** MIT License
+** Copyright (c) 2017 636F57@GitHub
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE
+*/
+
+#ifndef BIGTHREADS_H
+#define BIGTHREADS_H
+
+#include <cstddef>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <algorithm>
+
+class BigThreads
+{
+public:
+	// number of threads used by the parallel kernels. 1 turns them off.
+	static void setCount(size_t nThreads)
+	{
+		countSetting() = std::max<size_t>(nThreads, 1);
+	}
+
+	static size_t count()
+	{
+		return inWorker() ? 1 : countSetting();
+	}
+
+	// call fTask(i) for every i in [0,nTasks) using up to count() threads including the calling one.
+	// the tasks are handed out one by one, so they do not need to be of the same size.
+	template<typename F>
+	static void parallelFor(size_t nTasks, F fTask)
+	{
+		size_t nThreads = std::min(count(), nTasks);
+		if (nThreads <= 1)
+		{
+			for (size_t i=0; i<nTasks; i++)
+				fTask(i);
+			return;
+		}
+
+		std::function<void(size_t)> fRun = [&](size_t i) { fTask(i); };
+		Job job(fRun, nTasks, nThreads - 1);
+		Pool& pool = Pool::instance();
+		pool.start(job);
+		bool bPrev = inWorker();
+		inWorker() = true;
+		try
+		{
+			job.run();
+		}
+		catch (...)
+		{
+			// the pool threads still working on the job must leave it before it goes out of scope
+			job.nNext = nTasks;
+			inWorker() = bPrev;
+			pool.finish(job);
+			throw;
+		}
+		inWorker() = bPrev;
+		pool.finish(job);
+	}
+
+private:
+	// one parallelFor. the caller and up to nMaxHelpers pool threads take its tasks.
+	struct Job
+	{
+		const std::function<void(size_t)>& fTask;
+		size_t nTasks;
+		size_t nMaxHelpers;
+		size_t nHelpers;  // pool threads working on it, under the pool mutex
+		std::atomic<size_t> nNext;
+
+		Job(const std::function<void(size_t)>& f, size_t n, size_t nMax) : fTask(f), nTasks(n), nMaxHelpers(nMax), nHelpers(0), nNext(0) {}
+
+		void run()
+		{
+			for (size_t i=nNext++; i<nTasks; i=nNext++)
+				fTask(i);
+		}
+
+		bool exhausted() const
+		{
+			return nNext.load() >= nTasks;
+		}
+	};
+
+	// threads which live as long as the program and wait for jobs, so that a parallelFor costs a wake-up
+	// rather than the creation of its threads. jobs from several calling threads are served in order.
+	class Pool
+	{
+	private:
+		std::mutex mtx;
+		std::condition_variable cvWork;  // a job was queued, or the pool is stopping
+		std::condition_variable cvDone;  // a pool thread left a job
+		std::deque<Job*> dqJobs;         // jobs which can still take helpers
+		std::vector<std::thread> vThreads;
+		bool bStop;
+
+		void work()
+		{
+			inWorker() = true;
+			std::unique_lock<std::mutex> lock(mtx);
+			while (true)
+			{
+				cvWork.wait(lock, [this]() { return bStop || !dqJobs.empty(); });
+				if (bStop)
+					return;
+				Job* pJob = dqJobs.front();
+				if (pJob->exhausted())
+				{
+					dqJobs.pop_front();
+					continue;
+				}
+				if (++pJob->nHelpers == pJob->nMaxHelpers)
+					dqJobs.pop_front();
+				lock.unlock();
+				pJob->run();
+				lock.lock();
+				if (--pJob->nHelpers == 0)
+					cvDone.notify_all();
+			}
+		}
+
+	public:
+		Pool() : bStop(false) {}
+
+		~Pool()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mtx);
+				bStop = true;
+			}
+			cvWork.notify_all();
+			for (size_t t=0; t<vThreads.size(); t++)
+				vThreads[t].join();
+		}
+
+		static Pool& instance()
+		{
+			static Pool pool;
+			return pool;
+		}
+
+		// queue the job, starting more pool threads if it can use more than there are
+		void start(Job& job)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mtx);
+				while (vThreads.size() < job.nMaxHelpers)
+					vThreads.emplace_back(&Pool::work, this);
+				dqJobs.push_back(&job);
+			}
+			cvWork.notify_all();
+		}
+
+		// after the caller has run out of tasks: wait for the pool threads still running some
+		void finish(Job& job)
+		{
+			std::unique_lock<std::mutex> lock(mtx);
+			std::deque<Job*>::iterator it = std::find(dqJobs.begin(), dqJobs.end(), &job);
+			if (it != dqJobs.end())
+				dqJobs.erase(it);
+			cvDone.wait(lock, [&job]() { return job.nHelpers == 0; });
+		}
+	};
+
+	static size_t& countSetting()
+	{
+		static size_t nCount = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+		return nCount;
+	}
+
+	static bool& inWorker()
+	{
+		static thread_local bool bInWorker = false;
+		return bInWorker;
+	}
+};
+
+#endif
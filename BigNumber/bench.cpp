@@ -0,0 +1,270 @@
+/* bench.cpp
+** Benchmark of the big integer kernels over operand sizes from 10 to 10^7 decimal digits.
+** Measures add, sub, mul, square, div (2n by n limbs) and the decimal conversions in both directions,
+** and reports the time per operation and per limb, the throughput on the operand bytes and the peak memory.
+**
+** usage: bench [--min-digits N] [--max-digits N] [--ops add,sub,mul,sqr,div,fromdec,todec]
+**              [--threads N] [--time SECONDS] [--format table|csv|json] [--output FILE]
+** each measurement is repeated until it has taken at least --time seconds (0.2 by default).
+** the sizes go 1, 2, 5 times each power of 10. the largest sizes take minutes for div and the conversions.
+**
+** MIT License
+** Copyright (c) 2017 636F57@GitHub
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE
+*/
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <functional>
+#include <stdexcept>
+#include <sys/resource.h>
+#include "BigKernels.h"
+#include "BigConvert.h"
+#include "BigScratch.h"
+#include "BigThreads.h"
+
+typedef BigKernels::limb_t limb_t;
+
+struct BenchResult
+{
+	std::string strOp;
+	size_t nDigits;
+	size_t nLimbs;
+	size_t nRepeat;
+	double dSeconds;       // per operation
+	size_t nPeakRssKB;     // of the process so far
+	size_t nPeakScratchKB; // of this thread's arena so far
+};
+
+// peak resident set size of the process in KB
+size_t peakRssKB()
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+	return (size_t)usage.ru_maxrss;
+}
+
+// n limbs of pseudo-random data with a non-zero top limb
+std::vector<limb_t> randomLimbs(size_t n, uint32_t nSeed)
+{
+	std::vector<limb_t> vLimbs(n);
+	for (size_t i=0; i<n; i++)
+	{
+		nSeed ^= nSeed << 13; nSeed ^= nSeed >> 17; nSeed ^= nSeed << 5;
+		vLimbs[i] = nSeed;
+	}
+	if (n > 0)
+		vLimbs[n-1] |= 1;
+	return vLimbs;
+}
+
+std::string randomDigits(size_t nDigits, uint32_t nSeed)
+{
+	std::string strDigits(nDigits, '0');
+	for (size_t i=0; i<nDigits; i++)
+	{
+		nSeed ^= nSeed << 13; nSeed ^= nSeed >> 17; nSeed ^= nSeed << 5;
+		strDigits[i] = '0' + nSeed % 10;
+	}
+	strDigits[0] = '1' + nSeed % 9;
+	return strDigits;
+}
+
+// average seconds of fOperation, repeated until dMinTime has passed
+double timeOperation(const std::function<void()>& fOperation, double dMinTime, size_t& nRepeat)
+{
+	nRepeat = 0;
+	std::chrono::steady_clock::time_point tStart = std::chrono::steady_clock::now();
+	double dElapsed = 0;
+	do
+	{
+		fOperation();
+		nRepeat++;
+		dElapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - tStart).count();
+	} while (dElapsed < dMinTime);
+	return dElapsed / nRepeat;
+}
+
+BenchResult runBench(const std::string& strOp, size_t nDigits, double dMinTime)
+{
+	// 32*log10(2) = 9.63 digits per limb
+	size_t nLimbs = std::max<size_t>((size_t)(nDigits / 9.632959861247398), 1);
+	std::vector<limb_t> vA = randomLimbs(nLimbs, 2463534242u);
+	std::vector<limb_t> vB = randomLimbs(nLimbs, 88675123u);
+	std::vector<limb_t> vR(2*nLimbs + 1);
+	std::function<void()> fOperation;
+	std::string strDigits;
+	std::vector<limb_t> vWide, vQ;
+
+	if (strOp == "add")
+		fOperation = [&]() { BigKernels::add(vR.data(), vA.data(), nLimbs, vB.data(), nLimbs); };
+	else if (strOp == "sub")
+		fOperation = [&]() { BigKernels::sub(vR.data(), vA.data(), nLimbs, vB.data(), nLimbs); };
+	else if (strOp == "mul")
+		fOperation = [&]() { BigKernels::mul(vR.data(), vA.data(), nLimbs, vB.data(), nLimbs); };
+	else if (strOp == "sqr")
+		fOperation = [&]() { BigKernels::sqr(vR.data(), vA.data(), nLimbs); };
+	else if (strOp == "div")
+	{
+		vWide = randomLimbs(2*nLimbs, 521288629u);
+		vQ.resize(nLimbs + 1);
+		fOperation = [&]() { BigKernels::divmod(vQ.data(), vR.data(), vWide.data(), 2*nLimbs, vB.data(), nLimbs); };
+	}
+	else if (strOp == "fromdec")
+	{
+		strDigits = randomDigits(nDigits, 3141592653u);
+		fOperation = [&]() { BigConvert::fromDecimal(strDigits.data(), strDigits.size()); };
+	}
+	else if (strOp == "todec")
+		fOperation = [&]() { BigConvert::toDecimal(vA.data(), nLimbs); };
+	else
+		throw std::invalid_argument("unknown operation " + strOp);
+
+	BenchResult result;
+	result.strOp = strOp;
+	result.nDigits = nDigits;
+	result.nLimbs = nLimbs;
+	result.dSeconds = timeOperation(fOperation, dMinTime, result.nRepeat);
+	result.nPeakRssKB = peakRssKB();
+	result.nPeakScratchKB = BigScratch::current().peak() / 1024;
+	return result;
+}
+
+// 1, 2, 5 times the powers of 10 in [nMin,nMax]
+std::vector<size_t> digitSizes(size_t nMin, size_t nMax)
+{
+	std::vector<size_t> vSizes;
+	for (size_t nPow=1; nPow<=nMax; nPow*=10)
+	{
+		const size_t aSteps[3] = {1, 2, 5};
+		for (int i=0; i<3; i++)
+		{
+			size_t nSize = nPow * aSteps[i];
+			if ((nSize >= nMin) && (nSize <= nMax))
+				vSizes.push_back(nSize);
+		}
+		if (nPow > nMax / 10)
+			break;
+	}
+	return vSizes;
+}
+
+std::vector<std::string> splitList(const std::string& strList)
+{
+	std::vector<std::string> vItems;
+	std::stringstream ss(strList);
+	std::string strItem;
+	while (std::getline(ss, strItem, ','))
+	{
+		if (!strItem.empty())
+			vItems.push_back(strItem);
+	}
+	return vItems;
+}
+
+void printHeader(std::ostream& os, const std::string& strFormat)
+{
+	if (strFormat == "csv")
+		os << "op,digits,limbs,repeat,ns_per_op,ns_per_limb,mb_per_s,peak_rss_kb,peak_scratch_kb\n";
+	else if (strFormat == "json")
+		os << "[\n";
+	else
+		os << std::left << std::setw(8) << "op" << std::right << std::setw(10) << "digits" << std::setw(10) << "limbs"
+		   << std::setw(14) << "ns/op" << std::setw(12) << "ns/limb" << std::setw(12) << "MB/s"
+		   << std::setw(14) << "peak RSS KB" << std::setw(14) << "scratch KB" << "\n";
+}
+
+void printResult(std::ostream& os, const std::string& strFormat, const BenchResult& result, bool bFirst)
+{
+	double dNsPerOp = result.dSeconds * 1e9;
+	double dNsPerLimb = dNsPerOp / result.nLimbs;
+	double dMBPerSec = result.nLimbs * sizeof(limb_t) / result.dSeconds / 1e6;
+	if (strFormat == "csv")
+	{
+		os << result.strOp << "," << result.nDigits << "," << result.nLimbs << "," << result.nRepeat << ","
+		   << dNsPerOp << "," << dNsPerLimb << "," << dMBPerSec << "," << result.nPeakRssKB << "," << result.nPeakScratchKB << "\n";
+	}
+	else if (strFormat == "json")
+	{
+		os << (bFirst ? "" : ",\n") << "  {\"op\": \"" << result.strOp << "\", \"digits\": " << result.nDigits
+		   << ", \"limbs\": " << result.nLimbs << ", \"repeat\": " << result.nRepeat
+		   << ", \"ns_per_op\": " << dNsPerOp << ", \"ns_per_limb\": " << dNsPerLimb << ", \"mb_per_s\": " << dMBPerSec
+		   << ", \"peak_rss_kb\": " << result.nPeakRssKB << ", \"peak_scratch_kb\": " << result.nPeakScratchKB << "}";
+	}
+	else
+	{
+		os << std::left << std::setw(8) << result.strOp << std::right << std::setw(10) << result.nDigits
+		   << std::setw(10) << result.nLimbs << std::setw(14) << std::setprecision(6) << dNsPerOp
+		   << std::setw(12) << dNsPerLimb << std::setw(12) << dMBPerSec
+		   << std::setw(14) << result.nPeakRssKB << std::setw(14) << result.nPeakScratchKB << "\n";
+	}
+	os.flush();
+}
+
+int main(int argc, char* argv[])
+{
+	size_t nMinDigits = 10, nMaxDigits = 10000000;
+	std::vector<std::string> vOps = splitList("add,sub,mul,sqr,div,fromdec,todec");
+	std::string strFormat = "table", strOutput;
+	double dMinTime = 0.2;
+
+	for (int i=1; i+1<argc; i+=2)
+	{
+		std::string strArg = argv[i], strValue = argv[i+1];
+		if (strArg == "--min-digits")
+			nMinDigits = std::strtoull(strValue.c_str(), nullptr, 10);
+		else if (strArg == "--max-digits")
+			nMaxDigits = std::strtoull(strValue.c_str(), nullptr, 10);
+		else if (strArg == "--ops")
+			vOps = splitList(strValue);
+		else if (strArg == "--threads")
+			BigThreads::setCount(std::strtoull(strValue.c_str(), nullptr, 10));
+		else if (strArg == "--time")
+			dMinTime = std::atof(strValue.c_str());
+		else if (strArg == "--format")
+			strFormat = strValue;
+		else if (strArg == "--output")
+			strOutput = strValue;
+		else
+		{
+			std::cerr << "unknown option " << strArg << std::endl;
+			return 1;
+		}
+	}
+
+	std::ofstream ofs;
+	if (!strOutput.empty())
+		ofs.open(strOutput);
+	std::ostream& os = strOutput.empty() ? std::cout : ofs;
+
+	printHeader(os, strFormat);
+	bool bFirst = true;
+	try
+	{
+		for (size_t i=0; i<vOps.size(); i++)
+		{
+			std::vector<size_t> vSizes = digitSizes(nMinDigits, nMaxDigits);
+			for (size_t j=0; j<vSizes.size(); j++)
+			{
+				printResult(os, strFormat, runBench(vOps[i], vSizes[j], dMinTime), bFirst);
+				bFirst = false;
+			}
+		}
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	if (strFormat == "json")
+		os << "\n]\n";
+
+	return 0;
+}
@@ -0,0 +1,68 @@
+/* division.cpp 
+** Big Integer numbers division and modulo functions.
+** Quotients are rounded toward zero and remainders take the sign of the dividend, as for the built-in integers.
+**
+** MIT License 
+** Copyright (c) 2017 636F57@GitHub 
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE 
+*/
+
+#include <string>
+#include <utility>
+#include <stdexcept>
+#include <iostream>
+#include "BigInt.h"
+#include "BigFile.h"
+
+
+// quotient of big integers, strNum1 / strNum2. thin wrapper of BigInt
+std::string divInt(const std::string& strNum1, const std::string& strNum2)
+{
+	return (BigInt(strNum1) / BigInt(strNum2)).toString();
+}
+
+// remainder of big integers, strNum1 % strNum2. thin wrapper of BigInt
+std::string modInt(const std::string& strNum1, const std::string& strNum2)
+{
+	return (BigInt(strNum1) % BigInt(strNum2)).toString();
+}
+
+// quotient and remainder at once
+std::pair<std::string, std::string> divmodInt(const std::string& strNum1, const std::string& strNum2)
+{
+	BigInt biQuot, biRem;
+	BigInt::divmod(BigInt(strNum1), BigInt(strNum2), biQuot, biRem);
+	return std::make_pair(biQuot.toString(), biRem.toString());
+}
+
+// file mode: quotient of the numbers in two files written to a third, and the remainder to an optional fourth
+int main(int argc, char* argv[])
+{
+	try
+	{
+		if (argc >= 4)
+		{
+			BigInt biQuot, biRem;
+			BigInt::divmod(BigFile::read(argv[1]), BigFile::read(argv[2]), biQuot, biRem);
+			BigFile::write(argv[3], biQuot);
+			if (argc >= 5)
+				BigFile::write(argv[4], biRem);
+			return 0;
+		}
+		
+		std::cout << "Enter two numbers as base-10 integers." << std::endl;
+		std::string strNum1, strNum2;
+		std::cin >> strNum1;
+		std::cin >> strNum2;
+		
+		std::pair<std::string, std::string> pairResult = divmodInt(strNum1, strNum2);
+		std::cout << "Quotient : " << pairResult.first << "\nRemainder : " << pairResult.second << std::endl;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	
+	return 0;
+}
@@ -0,0 +1,35 @@
+/* fixed.cpp 
+** 256-bit fixed-width integer multiplication function.
+** The operands live on the stack (see BigFixed.h). the full 512-bit product is returned.
+**
+** MIT License 
+** Copyright (c) 2017 636F57@GitHub 
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE 
+*/
+
+#include <string>
+#include <iostream>
+#include "BigFixed.h"
+
+// 2^255 - 19 folded at compile time
+constexpr BigUInt<256> P25519 = (BigUInt<256>(1) << 255) - BigUInt<256>(19);
+static_assert(P25519.limb(0) == 0xFFFFFFFFFFFFFFEDULL, "constant folding of BigUInt");
+
+
+// full product of two 256-bit unsigned integers, each taken modulo 2^256. thin wrapper of BigUInt
+std::string multiplyUInt256(const std::string& strNum1, const std::string& strNum2)
+{
+	return BigUInt<256>::mulWide(BigUInt<256>(strNum1), BigUInt<256>(strNum2)).toString();
+}
+
+int main()
+{
+	std::cout << "Enter two numbers as base-10 integers below 2^256." << std::endl;
+	std::string strNum1, strNum2;
+	std::cin >> strNum1;
+	std::cin >> strNum2;
+	
+	std::cout << multiplyUInt256(strNum1, strNum2) << std::endl;
+	
+	return 0;
+}
@@ -0,0 +1,45 @@
+/* powmod.cpp 
+** Big Integer modular exponentiation function.
+** Odd moduli use Montgomery multiplication with a sliding window over the exponent (see BigMontgomery.h).
+**
+** MIT License 
+** Copyright (c) 2017 636F57@GitHub 
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE 
+*/
+
+#include <string>
+#include <stdexcept>
+#include <iostream>
+#include "BigInt.h"
+#include "BigMontgomery.h"
+
+
+// strBase ^ strExp mod strMod, in [0,strMod). thin wrapper of BigMontgomery
+std::string powmodInt(const std::string& strBase, const std::string& strExp, const std::string& strMod)
+{
+	return BigMontgomery::powmod(BigInt(strBase), BigInt(strExp), BigInt(strMod)).toString();
+}
+
+int main()
+{
+	std::cout << "Enter the base, the exponent and the modulus as base-10 integers." << std::endl;
+	std::string strBase, strExp, strMod;
+	std::cin >> strBase;
+	std::cin >> strExp;
+	std::cin >> strMod;
+	
+	std::string strResult;
+	try
+	{
+		strResult = powmodInt(strBase, strExp, strMod);
+	}
+	catch (const std::domain_error& e)
+	{
+		std::cerr << e.what() << "\nthe exponent must be at least 0 and the modulus at least 1." << std::endl;
+		return 1;
+	}
+	
+	std::cout << "Result : " << strResult << std::endl;
+	
+	return 0;
+}
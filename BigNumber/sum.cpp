@@ -0,0 +1,32 @@
+/* sum.cpp 
+** Sum of many big integers read from the standard input, using BigAccumulator.
+**
+** MIT License 
+** Copyright (c) 2017 636F57@GitHub 
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE 
+*/
+
+#include <string>
+#include <iostream>
+#include "BigAccumulator.h"
+
+
+int main()
+{
+	std::cout << "Enter base-10 integers separated by spaces or new lines, and end with EOF." << std::endl;
+	
+	std::ios::sync_with_stdio(false);
+	BigAccumulator accSum;
+	try
+	{
+		size_t nCount = accSum.addFromStream(std::cin);
+		std::cout << "The sum of " << nCount << " numbers : " << accSum.toString() << std::endl;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	
+	return 0;
+}
@@ -0,0 +1,31 @@
+/* tune.cpp
+** Measure the crossover points of the big integer multiplication algorithms on this machine.
+** Put the printed values into BigKernels::tuning() at start-up, or use them as the new defaults in BigKernels.h.
+**
+** MIT License
+** Copyright (c) 2017 636F57@GitHub
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE
+*/
+
+#include <iostream>
+#include "BigKernels.h"
+
+int main()
+{
+	std::cout << "Calibrating the multiplication thresholds..." << std::endl;
+
+	BigKernels::Tuning tuningResult = BigKernels::calibrateMul();
+
+	std::cout << "Karatsuba threshold : " << tuningResult.nKaratsuba << " limbs\n";
+	if (tuningResult.nToom3 == (size_t)-1)
+		std::cout << "Toom-3 threshold    : not reached\n";
+	else
+		std::cout << "Toom-3 threshold    : " << tuningResult.nToom3 << " limbs\n";
+	if (tuningResult.nNTT == (size_t)-1)
+		std::cout << "NTT threshold       : not reached\n";
+	else
+		std::cout << "NTT threshold       : " << tuningResult.nNTT << " limbs\n";
+	std::cout << "Peak scratch memory : " << BigScratch::current().peak() / 1024 << " KB (during the calibration)\n";
+
+	return 0;
+}
@@ -0,0 +1,401 @@
+/* extsort.cpp
+**
+** External-memory merge sort of binary files of 32-bit integers (native byte order), for files larger than
+** the memory. Stable, and counts the inversions of the whole file like recur_mergesort in mergesort.h.
+**
+** usage: extsort <input> <output> [--memory MB] [--threads N] [--tmp DIR]
+** --memory caps the memory used for the data (1024 MB by default). it must be at least 4 MB, for the two runs and
+** the two output blocks of the smallest merge.
+**
+** 1. runs: the input is read in runs of a third of the memory budget. each run is sorted in memory by
+**    parallel_mergesort while the previous one is being written to a temporary file.
+** 2. merge: the runs are merged k at a time with the loser tree of losertree.h, reading each run and writing
+**    the output in large sequential blocks. the output is written by a background thread while the next block
+**    is merged, and the kernel is asked to read ahead the next block of every run. when there are more runs than the budget
+**    allows blocks for, consecutive runs are merged in groups first, over as many passes as needed.
+**
+** the inversions inside each run are counted by the sort. when the merge outputs an element from run j,
+** every element left in the runs before j is greater than it (equal ones would have been taken first, as the
+** merge is stable), so it adds the number of elements left in those runs, kept in a FenwickTree over the runs.
+**
+** compiled and tested with g++ 12.2.0 (POSIX file I/O, compile with -pthread)
+**
+** MIT License
+** Copyright (c) 2017 636F57@GitHub
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <memory>
+#include <future>
+#include <utility>
+#include <functional>
+#include <stdexcept>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "mergesort.h"
+#include "losertree.h"
+
+class ExtSortCls
+{
+public:
+	struct Options
+	{
+		size_t nMemoryBytes = (size_t)1 << 30;  // cap of the memory used for the data
+		size_t nThreads = 0;                    // for sorting the runs. 0 uses all the cores.
+		std::string strTmpDir;                  // for the runs. the directory of the output when empty.
+	};
+
+private:
+	static const size_t MIN_BLOCK = (size_t)1 << 18;  // smallest read or write block, in elements (1 MB)
+	static const size_t MIN_MEMORY_BLOCKS = 4;         // the smallest memory budget, in MIN_BLOCKs
+
+	static int openRead(const std::string& strPath)
+	{
+		int nFd = open(strPath.c_str(), O_RDONLY);
+		if (nFd < 0)
+			throw std::runtime_error("extsort: cannot open " + strPath);
+		posix_fadvise(nFd, 0, 0, POSIX_FADV_SEQUENTIAL);
+		return nFd;
+	}
+
+	static int openWrite(const std::string& strPath)
+	{
+		int nFd = open(strPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+		if (nFd < 0)
+			throw std::runtime_error("extsort: cannot create " + strPath);
+		return nFd;
+	}
+
+	static size_t fileElements(int nFd, const std::string& strPath)
+	{
+		struct stat st;
+		if (fstat(nFd, &st) != 0)
+			throw std::runtime_error("extsort: cannot stat " + strPath);
+		if (st.st_size % sizeof(int) != 0)
+			throw std::runtime_error("extsort: the size of " + strPath + " is not a multiple of 4 bytes");
+		return (size_t)st.st_size / sizeof(int);
+	}
+
+	// read up to n elements, fewer only at the end of the file
+	static size_t readInts(int nFd, int* p, size_t n)
+	{
+		char* pBytes = (char*)p;
+		size_t nBytes = n * sizeof(int), nDone = 0;
+		while (nDone < nBytes)
+		{
+			ssize_t nRead = read(nFd, pBytes + nDone, nBytes - nDone);
+			if (nRead < 0)
+				throw std::runtime_error("extsort: read error");
+			if (nRead == 0)
+				break;
+			nDone += nRead;
+		}
+		return nDone / sizeof(int);
+	}
+
+	static void writeInts(int nFd, const int* p, size_t n)
+	{
+		const char* pBytes = (const char*)p;
+		size_t nBytes = n * sizeof(int), nDone = 0;
+		while (nDone < nBytes)
+		{
+			ssize_t nWritten = write(nFd, pBytes + nDone, nBytes - nDone);
+			if (nWritten <= 0)
+				throw std::runtime_error("extsort: write error");
+			nDone += nWritten;
+		}
+	}
+
+	// sequential reader of one run through a block buffer
+	class RunReader
+	{
+	private:
+		int nFd;
+		std::vector<int> vBlock;
+		size_t nPos = 0, nLen = 0;
+		off_t nOffset = 0;
+
+	public:
+		size_t nLeft;  // elements not taken yet
+
+		RunReader(const std::string& strPath, size_t nBlock) : vBlock(nBlock)
+		{
+			nFd = openRead(strPath);
+			try
+			{
+				nLeft = fileElements(nFd, strPath);
+			}
+			catch (...)
+			{
+				close(nFd);
+				throw;
+			}
+		}
+		~RunReader()
+		{
+			close(nFd);
+		}
+		RunReader(const RunReader&) = delete;
+		RunReader& operator=(const RunReader&) = delete;
+
+		// the next element. must not be called when nLeft == 0.
+		int next()
+		{
+			if (nPos == nLen)
+			{
+				nLen = readInts(nFd, vBlock.data(), vBlock.size());
+				nPos = 0;
+				nOffset += nLen * sizeof(int);
+				if (nLen == 0)
+					throw std::runtime_error("extsort: a run ended early");
+				// start reading the next block while this one is merged
+				posix_fadvise(nFd, nOffset, vBlock.size() * sizeof(int), POSIX_FADV_WILLNEED);
+			}
+			nLeft--;
+			return vBlock[nPos++];
+		}
+	};
+
+	// output through two block buffers, one filled while the other is written by a background thread
+	class BlockWriter
+	{
+	private:
+		int nFd;
+		std::vector<int> vFill, vWrite;
+		size_t nFill = 0;
+		std::future<void> futureWrite;
+
+		void flush()
+		{
+			if (futureWrite.valid())
+				futureWrite.get();
+			vFill.swap(vWrite);
+			size_t nCount = nFill;
+			nFill = 0;
+			futureWrite = std::async(std::launch::async, [this, nCount]() { writeInts(nFd, vWrite.data(), nCount); });
+		}
+
+	public:
+		BlockWriter(const std::string& strPath, size_t nBlock) : vFill(nBlock), vWrite(nBlock)
+		{
+			nFd = openWrite(strPath);
+		}
+		~BlockWriter()
+		{
+			if (futureWrite.valid())
+				futureWrite.wait();
+			close(nFd);
+		}
+		BlockWriter(const BlockWriter&) = delete;
+		BlockWriter& operator=(const BlockWriter&) = delete;
+
+		void put(int nValue)
+		{
+			vFill[nFill++] = nValue;
+			if (nFill == vFill.size())
+				flush();
+		}
+
+		void finish()
+		{
+			flush();
+			futureWrite.get();
+		}
+	};
+
+	// merge the runs, in this order of the input, into strOut and return the inversions between them
+	static long long mergeRuns(const std::vector<std::string>& vRuns, const std::string& strOut, size_t nBlock)
+	{
+		size_t k = vRuns.size();
+		std::vector<std::unique_ptr<RunReader>> vReaders;
+		FenwickTree treeLeft(k);
+		for (size_t i=0; i<k; i++)
+		{
+			vReaders.emplace_back(new RunReader(vRuns[i], nBlock));
+			treeLeft.add(i, vReaders[i]->nLeft);
+		}
+		BlockWriter writer(strOut, nBlock);
+
+		// equal values come out in the order of the runs, which keeps the sort stable
+		LoserTree tree(k);
+		for (size_t i=0; i<k; i++)
+		{
+			if (vReaders[i]->nLeft > 0)
+				tree.set(i, vReaders[i]->next());
+		}
+		tree.build();
+
+		long long lCnt = 0;
+		while (!tree.empty())
+		{
+			size_t nRun = tree.top();
+			writer.put(tree.topValue());
+			lCnt += treeLeft.prefix(nRun);
+			treeLeft.add(nRun, -1);
+			if (vReaders[nRun]->nLeft > 0)
+				tree.replaceTop(vReaders[nRun]->next());
+			else
+				tree.removeTop();
+		}
+		writer.finish();
+		return lCnt;
+	}
+
+	static std::string runPath(const std::string& strOut, const Options& options, size_t nPass, size_t nRun)
+	{
+		std::string strBase = strOut;
+		if (!options.strTmpDir.empty())
+		{
+			size_t nSlash = strOut.find_last_of('/');
+			strBase = options.strTmpDir + "/" + ((nSlash == std::string::npos) ? strOut : strOut.substr(nSlash + 1));
+		}
+		return strBase + ".run" + std::to_string(nPass) + "_" + std::to_string(nRun);
+	}
+
+	static void removeRuns(const std::vector<std::string>& vRuns)
+	{
+		for (size_t i=0; i<vRuns.size(); i++)
+			std::remove(vRuns[i].c_str());
+	}
+
+public:
+	ExtSortCls(){}
+	~ExtSortCls(){}
+
+	// sort strIn into strOut and return the number of inversions found in strIn
+	static long long sortFile(const std::string& strIn, const std::string& strOut, const Options& options)
+	{
+		// two runs and two output blocks of MIN_BLOCK elements for the smallest merge
+		if (options.nMemoryBytes < MIN_MEMORY_BLOCKS * MIN_BLOCK * sizeof(int))
+			throw std::invalid_argument("extsort: the memory budget must be at least " + std::to_string(MIN_MEMORY_BLOCKS * MIN_BLOCK * sizeof(int) >> 20) + " MB");
+		size_t nBudget = options.nMemoryBytes / sizeof(int);
+		// a run being sorted, its merge buffer and the previous run being written
+		size_t nRunLen = nBudget / 3;
+		long long lCnt = 0;
+		std::vector<std::string> vRuns;
+
+		// 1. sorted runs
+		{
+			int nFd = openRead(strIn);
+			std::vector<int> vRun, vWriting;
+			std::future<void> futureWrite;
+			try
+			{
+				size_t nTotal = fileElements(nFd, strIn);
+				bool bSingle = (nTotal <= nRunLen);
+				for (size_t nDone=0; (nDone < nTotal) || (nTotal == 0); )
+				{
+					vRun.resize(std::min(nRunLen, nTotal - nDone));
+					if (readInts(nFd, vRun.data(), vRun.size()) != vRun.size())
+						throw std::runtime_error("extsort: " + strIn + " ended early");
+					nDone += vRun.size();
+					lCnt += parallel_mergesort(vRun, options.nThreads);
+
+					// the run is written while the next one is read and sorted
+					if (futureWrite.valid())
+						futureWrite.get();
+					vRun.swap(vWriting);
+					std::string strRun = bSingle ? strOut : runPath(strOut, options, 0, vRuns.size());
+					if (!bSingle)
+						vRuns.push_back(strRun);
+					futureWrite = std::async(std::launch::async, [strRun, &vWriting]() {
+						int nOut = openWrite(strRun);
+						writeInts(nOut, vWriting.data(), vWriting.size());
+						close(nOut);
+					});
+					if (nTotal == 0)
+						break;
+				}
+				if (futureWrite.valid())
+					futureWrite.get();
+			}
+			catch (...)
+			{
+				if (futureWrite.valid())
+					futureWrite.wait();
+				close(nFd);
+				removeRuns(vRuns);
+				throw;
+			}
+			close(nFd);
+		}
+		if (vRuns.empty())
+			return lCnt;
+
+		// 2. merge passes. every run and the output get a block of at least MIN_BLOCK elements (the output two).
+		size_t nFanIn = nBudget / MIN_BLOCK - 2;
+		try
+		{
+			for (size_t nPass=1; ; nPass++)
+			{
+				if (vRuns.size() <= nFanIn)
+				{
+					lCnt += mergeRuns(vRuns, strOut, nBudget / (vRuns.size() + 2));
+					removeRuns(vRuns);
+					break;
+				}
+				std::vector<std::string> vMerged;
+				for (size_t i=0; i<vRuns.size(); i+=nFanIn)
+				{
+					std::vector<std::string> vGroup(vRuns.begin() + i, vRuns.begin() + std::min(i + nFanIn, vRuns.size()));
+					vMerged.push_back(runPath(strOut, options, nPass, vMerged.size()));
+					lCnt += mergeRuns(vGroup, vMerged.back(), nBudget / (vGroup.size() + 2));
+					removeRuns(vGroup);
+				}
+				vRuns.swap(vMerged);
+			}
+		}
+		catch (...)
+		{
+			removeRuns(vRuns);
+			throw;
+		}
+		return lCnt;
+	}
+};
+
+int main(int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		std::cout << "usage: extsort <input> <output> [--memory MB] [--threads N] [--tmp DIR]\n";
+		std::cout << "--memory is the memory for the data, 1024 MB by default and at least 4 MB.\n";
+		std::cout << "sorts a binary file of 32-bit integers and shows the number of inversions found in it.\n";
+		return 1;
+	}
+
+	ExtSortCls::Options options;
+	for (int i=3; i+1<argc; i+=2)
+	{
+		std::string strArg = argv[i];
+		if (strArg == "--memory")
+			options.nMemoryBytes = std::strtoull(argv[i+1], nullptr, 10) << 20;
+		else if (strArg == "--threads")
+			options.nThreads = std::strtoull(argv[i+1], nullptr, 10);
+		else if (strArg == "--tmp")
+			options.strTmpDir = argv[i+1];
+		else
+		{
+			std::cerr << "unknown option " << strArg << std::endl;
+			return 1;
+		}
+	}
+
+	try
+	{
+		long long lCnt = ExtSortCls::sortFile(argv[1], argv[2], options);
+		std::cout << "The number of inversions found in the original seaquence : " << std::to_string(lCnt) << "\n";
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+	return 0;
+}
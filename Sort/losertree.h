@@ -0,0 +1,197 @@
+/* losertree.h
+**
+** k-way merge of sorted integer sequences with a tournament tree of losers.
+**
+** The tree holds the current head of every source. Each internal node keeps the source which lost the match
+** played there, and the overall winner is kept at the top, so taking the smallest head and replacing it by
+** the next element of its source replays only the matches on the path of that leaf: log2(k) comparisons per
+** output element, against about 2*log2(k) for a binary heap.
+**
+** The heads are compared as one 64-bit key: the value (sign bit flipped so that the unsigned order is the
+** signed one) in the upper half and the source index in the lower half. Equal values therefore come out in
+** the order of the sources, which makes the merge stable, and an exhausted source gets the sentinel key
+** greater than every real key, so no match has to check for empty sources.
+**
+** LoserTree::merge merges in-memory arrays and can count the inversions between the sources, i.e. the pairs
+** (x, y) where x comes from an earlier source than y and x > y, which added to the inversions inside each
+** source gives the count recur_mergesort returns for the concatenation of the sources.
+** FenwickTree keeps the number of elements left in each source for that count.
+**
+** compiled and tested with g++ 12.2.0
+**
+** MIT License
+** Copyright (c) 2017 636F57@GitHub
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE
+*/
+
+#ifndef LOSERTREE_H
+#define LOSERTREE_H
+
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#include <utility>
+
+// prefix sums over n counters with updates and queries in log(n)
+class FenwickTree
+{
+private:
+	std::vector<long long> vTree;
+
+public:
+	explicit FenwickTree(size_t n) : vTree(n + 1, 0) {}
+
+	void add(size_t i, long long lValue)
+	{
+		for (i++; i<vTree.size(); i+=i&(~i+1))
+			vTree[i] += lValue;
+	}
+
+	// sum of the counters [0,i)
+	long long prefix(size_t i) const
+	{
+		long long lSum = 0;
+		for (; i>0; i-=i&(~i+1))
+			lSum += vTree[i];
+		return lSum;
+	}
+};
+
+class LoserTree
+{
+private:
+	static const uint64_t SENTINEL = ~(uint64_t)0;
+
+	size_t nLeaves;               // the number of sources rounded up to a power of 2
+	std::vector<uint64_t> vKeys;  // key of the head of each leaf. the padding leaves hold the sentinel.
+	std::vector<size_t> vLosers;  // vLosers[node] for node in [1,nLeaves), vLosers[0] is the winner
+
+	static uint64_t makeKey(int nValue, size_t nSource)
+	{
+		return ((uint64_t)((uint32_t)nValue ^ 0x80000000u) << 32) | nSource;
+	}
+
+	// play the matches from the leaf nSource up to the top
+	void replay(size_t nSource)
+	{
+		size_t nWinner = nSource;
+		for (size_t nNode=(nLeaves + nSource) / 2; nNode>0; nNode/=2)
+		{
+			if (vKeys[vLosers[nNode]] < vKeys[nWinner])
+				std::swap(nWinner, vLosers[nNode]);
+		}
+		vLosers[0] = nWinner;
+	}
+
+public:
+	// k sources, all empty until set() and build()
+	explicit LoserTree(size_t k)
+	{
+		nLeaves = 1;
+		while (nLeaves < k)
+			nLeaves *= 2;
+		vKeys.assign(nLeaves, (uint64_t)SENTINEL);
+		vLosers.assign(nLeaves, 0);
+	}
+
+	// the first element of source i. call build() after the first elements of all the sources are set.
+	void set(size_t i, int nValue)
+	{
+		vKeys[i] = makeKey(nValue, i);
+	}
+
+	// play all the matches once
+	void build()
+	{
+		// winners of the subtrees, bottom-up. node nLeaves+i is leaf i.
+		std::vector<size_t> vWinners(2 * nLeaves);
+		for (size_t i=0; i<nLeaves; i++)
+			vWinners[nLeaves + i] = i;
+		for (size_t nNode=nLeaves-1; nNode>0; nNode--)
+		{
+			size_t nLeft = vWinners[2*nNode], nRight = vWinners[2*nNode + 1];
+			bool bLeftWins = (vKeys[nLeft] <= vKeys[nRight]);
+			vWinners[nNode] = bLeftWins ? nLeft : nRight;
+			vLosers[nNode] = bLeftWins ? nRight : nLeft;
+		}
+		vLosers[0] = (nLeaves > 1) ? vWinners[1] : 0;
+	}
+
+	// true when all the sources are exhausted
+	bool empty() const
+	{
+		return vKeys[vLosers[0]] == SENTINEL;
+	}
+
+	// source of the smallest head
+	size_t top() const
+	{
+		return vLosers[0];
+	}
+
+	// the smallest head
+	int topValue() const
+	{
+		return (int)((uint32_t)(vKeys[vLosers[0]] >> 32) ^ 0x80000000u);
+	}
+
+	// replace the smallest head by the next element of its source
+	void replaceTop(int nValue)
+	{
+		size_t nSource = vLosers[0];
+		vKeys[nSource] = makeKey(nValue, nSource);
+		replay(nSource);
+	}
+
+	// remove the smallest head, whose source has no more elements
+	void removeTop()
+	{
+		size_t nSource = vLosers[0];
+		vKeys[nSource] = SENTINEL;
+		replay(nSource);
+	}
+
+	// merge the sorted vSources[i][0,vLengths[i]) into pOut. with bCountInversions, return the number of
+	// inversions between the sources (0 otherwise).
+	static long long merge(const std::vector<const int*>& vSources, const std::vector<size_t>& vLengths, int* pOut, bool bCountInversions = false)
+	{
+		size_t k = vSources.size();
+		LoserTree tree(k);
+		std::vector<const int*> vNext(k), vEnd(k);
+		FenwickTree treeLeft(bCountInversions ? k : 0);
+		size_t nTotal = 0;
+		for (size_t i=0; i<k; i++)
+		{
+			vNext[i] = vSources[i];
+			vEnd[i] = vSources[i] + vLengths[i];
+			if (vLengths[i] > 0)
+				tree.set(i, *vNext[i]++);
+			if (bCountInversions)
+				treeLeft.add(i, vLengths[i]);
+			nTotal += vLengths[i];
+		}
+		tree.build();
+
+		long long lCnt = 0;
+		for (int* pEnd=pOut+nTotal; pOut<pEnd; pOut++)
+		{
+			size_t nSource = tree.top();
+			*pOut = tree.topValue();
+			if (bCountInversions)
+			{
+				// what is left in the earlier sources is all greater, equal elements would have come first
+				lCnt += treeLeft.prefix(nSource);
+				treeLeft.add(nSource, -1);
+			}
+			// the sources are the caller's arrays, which cannot be ended with a sentinel. this test fails only
+			// once per source, so it is predicted and costs nothing measurable next to the replay.
+			if (vNext[nSource] < vEnd[nSource])
+				tree.replaceTop(*vNext[nSource]++);
+			else
+				tree.removeTop();
+		}
+		return lCnt;
+	}
+};
+
+#endif
@@ -1,66 +1,19 @@
 /* mergesort.cpp 
 **
-** Merge-sort library. Stable, always run at N*log(N)
+** Sorts an integer sequence given on the standard input with the merge-sort library in mergesort.h,
+** and shows the number of inversions found in it.
 **
-** return the sorted seaquence and the number of inversions found in the original seaquence
-**
-** compiled and tested with g++ 6.2.0 MinGW-W64
+** compiled and tested with g++ 12.2.0 (compile with -pthread)
 **
 ** MIT License 
 ** Copyright (c) 2017 636F57@GitHub 
 ** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE 
 */
 
-#include <cstdlib> 
+#include <string>
 #include <vector>
-#include <cmath>
 #include <iostream>
-
-// vArray is an array of integer vertices of [0,1,2,...,vArray.size()-1].
-long long recur_mergesort(std::vector<int>& vArray) 
-{
-	if (vArray.size() == 1)
-		return 0;
-	else
-	{	
-		// split and get them sorted
-		int nMiddle = ceil(vArray.size()/2);
-		std::vector<int> vArray1, vArray2;
-		long long lCnt;
-		vArray1.assign(vArray.begin(), vArray.begin()+nMiddle);
-		vArray2.assign(vArray.begin()+nMiddle, vArray.end());
-		lCnt = recur_mergesort(vArray1);
-		lCnt += recur_mergesort(vArray2);
-		
-		// merge the sorted arrays
-		for (int i=0, j=0, k=0; i<vArray.size(); i++)
-		{
-			if (j == vArray1.size())
-			{
-				vArray[i] = vArray2[k];
-				k++;
-			}
-			else if (k == vArray2.size())
-			{
-				vArray[i] = vArray1[j];
-				j++;
-			}
-			else if (vArray1[j] <= vArray2[k])
-			{
-				vArray[i] = vArray1[j];
-				j++;
-			}
-			else
-			{
-				vArray[i] = vArray2[k];
-				k++;
-				lCnt += nMiddle - j;
-			}
-		}
-		
-		return lCnt;
-	}
-}
+#include "mergesort.h"
 
 int main()
 {
@@ -79,7 +32,7 @@ int main()
 		vArray.push_back(std::stoi(strN));
 	}
 	
-	long long lCnt = recur_mergesort(vArray);
+	long long lCnt = parallel_mergesort(vArray);
 	
 	std::cout << "The number of inversions found in the original seaquence : " << std::to_string(lCnt) << "\n";
 	
@@ -0,0 +1,432 @@
+/* mergesort.h
+**
+** Merge-sort library. Stable, always run at N*log(N)
+**
+** return the sorted seaquence and the number of inversions found in the original seaquence
+**
+** recur_mergesort is the plain recursive version which copies both halves at each level.
+** bottomup_mergesort gives the same result without any allocation but one buffer of the array size:
+** runs of INSERTION_RUN elements are insertion-sorted in place, then merged in passes of doubling width
+** which go back and forth between the array and the buffer.
+** adaptive_mergesort is for input which is already partly sorted: it finds the natural runs (a strictly
+** descending run is reversed, which removes exactly its inversions), extends the runs shorter than
+** INSERTION_RUN by insertion, and merges the runs in the order of powersort, which keeps the merges balanced.
+** a merge leaves in place the head of the left run and the tail of the right run which are already in order,
+** and when one run keeps winning it gallops, taking the whole block by exponential search. sorted or reversed
+** input takes N-1 comparisons, and k runs about N*log(k).
+** parallel_mergesort sorts the two halves on separate threads down to one part per thread, and merges
+** each pair of halves over all of their threads: the output is split evenly along the merge path (co-ranking),
+** and every piece counts the inversions it crosses, so the sum is exactly that of the serial merge.
+**
+** compiled and tested with g++ 12.2.0 (compile with -pthread for parallel_mergesort)
+**
+** MIT License 
+** Copyright (c) 2017 636F57@GitHub 
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE 
+*/
+
+#ifndef MERGESORT_H
+#define MERGESORT_H
+
+#include <cstdlib> 
+#include <vector>
+#include <cmath>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <thread>
+
+// vArray is an array of integer vertices of [0,1,2,...,vArray.size()-1].
+inline long long recur_mergesort(std::vector<int>& vArray) 
+{
+	if (vArray.size() == 1)
+		return 0;
+	else
+	{	
+		// split and get them sorted
+		int nMiddle = ceil(vArray.size()/2);
+		std::vector<int> vArray1, vArray2;
+		long long lCnt;
+		vArray1.assign(vArray.begin(), vArray.begin()+nMiddle);
+		vArray2.assign(vArray.begin()+nMiddle, vArray.end());
+		lCnt = recur_mergesort(vArray1);
+		lCnt += recur_mergesort(vArray2);
+		
+		// merge the sorted arrays
+		for (int i=0, j=0, k=0; i<vArray.size(); i++)
+		{
+			if (j == vArray1.size())
+			{
+				vArray[i] = vArray2[k];
+				k++;
+			}
+			else if (k == vArray2.size())
+			{
+				vArray[i] = vArray1[j];
+				j++;
+			}
+			else if (vArray1[j] <= vArray2[k])
+			{
+				vArray[i] = vArray1[j];
+				j++;
+			}
+			else
+			{
+				vArray[i] = vArray2[k];
+				k++;
+				lCnt += nMiddle - j;
+			}
+		}
+		
+		return lCnt;
+	}
+}
+
+const size_t INSERTION_RUN = 32;  // length of the runs sorted by insertion before the merge passes
+
+// sort p[0,n) by insertion. every shift of an element over a greater one removes one inversion.
+inline long long insertion_sort(int* p, size_t n)
+{
+	long long lCnt = 0;
+	for (size_t i=1; i<n; i++)
+	{
+		int nValue = p[i];
+		size_t j = i;
+		while ((j > 0) && (p[j-1] > nValue))
+		{
+			p[j] = p[j-1];
+			j--;
+		}
+		p[j] = nValue;
+		lCnt += i - j;
+	}
+	return lCnt;
+}
+
+// merge the sorted pA[0,nA) and pB[0,nB) into pOut[0,nOut), starting from pA[i] and pB[j].
+// every element taken from pB jumps over the nA-i elements left in pA, which are the inversions counted.
+inline long long merge_runs(const int* pA, size_t nA, const int* pB, size_t nB, size_t i, size_t j, int* pOut, size_t nOut)
+{
+	long long lCnt = 0;
+	int* pEnd = pOut + nOut;
+	while ((pOut < pEnd) && (i < nA) && (j < nB))
+	{
+		if (pA[i] <= pB[j])
+			*pOut++ = pA[i++];
+		else
+		{
+			*pOut++ = pB[j++];
+			lCnt += nA - i;
+		}
+	}
+	while ((pOut < pEnd) && (i < nA))
+		*pOut++ = pA[i++];
+	while ((pOut < pEnd) && (j < nB))
+		*pOut++ = pB[j++];
+	return lCnt;
+}
+
+// sort p[0,n) with the help of pBuffer[0,n). pResult is set to whichever of the two holds the sorted result.
+inline long long bottomup_passes(int* p, int* pBuffer, size_t n, int*& pResult)
+{
+	long long lCnt = 0;
+	for (size_t nStart=0; nStart<n; nStart+=INSERTION_RUN)
+		lCnt += insertion_sort(p + nStart, std::min(INSERTION_RUN, n - nStart));
+
+	int* pIn = p;
+	int* pOut = pBuffer;
+	for (size_t nWidth=INSERTION_RUN; nWidth<n; nWidth*=2)
+	{
+		for (size_t nStart=0; nStart<n; nStart+=2*nWidth)
+		{
+			size_t nMiddle = std::min(nWidth, n - nStart);
+			size_t nEnd = std::min(2*nWidth, n - nStart);
+			lCnt += merge_runs(pIn + nStart, nMiddle, pIn + nStart + nMiddle, nEnd - nMiddle, 0, 0, pOut + nStart, nEnd);
+		}
+		std::swap(pIn, pOut);
+	}
+	pResult = pIn;
+	return lCnt;
+}
+
+// same sorted result and the same number of inversions as recur_mergesort, without the allocations per level.
+inline long long bottomup_mergesort(std::vector<int>& vArray)
+{
+	std::vector<int> vBuffer((vArray.size() > INSERTION_RUN) ? vArray.size() : 0);
+	int* pResult;
+	long long lCnt = bottomup_passes(vArray.data(), vBuffer.data(), vArray.size(), pResult);
+
+	// after an odd number of passes the result is in the buffer
+	if (pResult != vArray.data())
+		vArray.swap(vBuffer);
+	return lCnt;
+}
+
+const size_t MIN_GALLOP = 7;  // wins in a row after which adaptive_mergesort starts galloping
+
+// number of elements of p[0,n) which are not greater than nKey (bUpper) or less than nKey (!bUpper).
+// the search doubles its step from p[0], so it costs log of the answer rather than log(n).
+inline size_t gallop(int nKey, const int* p, size_t n, bool bUpper)
+{
+	size_t nLo = 0, nHi = 1;
+	while ((nHi <= n) && (bUpper ? (p[nHi-1] <= nKey) : (p[nHi-1] < nKey)))
+	{
+		nLo = nHi;
+		nHi = 2*nHi + 1;
+	}
+	nHi = std::min(nHi, n);
+	const int* pFound = bUpper ? std::upper_bound(p + nLo, p + nHi, nKey) : std::lower_bound(p + nLo, p + nHi, nKey);
+	return pFound - p;
+}
+
+// merge the sorted p[0,nMiddle) and p[nMiddle,n) in place, copying the left run to vBuffer.
+// counts the inversions like merge_runs, a block of the right run taken by galloping at once.
+inline long long gallop_merge(int* p, size_t nMiddle, size_t n, std::vector<int>& vBuffer)
+{
+	// the left elements up to the first right one and the right elements from the last left one stay
+	size_t nStart = gallop(p[nMiddle], p, nMiddle, true);
+	if (nStart == nMiddle)
+		return 0;
+	size_t nEnd = nMiddle + gallop(p[nMiddle-1], p + nMiddle, n - nMiddle, false);
+
+	size_t nA = nMiddle - nStart;
+	if (vBuffer.size() < nA)
+		vBuffer.resize(nA);
+	const int* pA = vBuffer.data();
+	std::copy(p + nStart, p + nMiddle, vBuffer.data());
+	int* pB = p + nMiddle;
+	int* pBEnd = p + nEnd;
+	int* pOut = p + nStart;
+	size_t i = 0;
+	size_t nMinGallop = MIN_GALLOP;
+	long long lCnt = 0;
+	while ((i < nA) && (pB < pBEnd))
+	{
+		// one element at a time until a run wins nMinGallop times in a row
+		size_t nWinsA = 0, nWinsB = 0;
+		while ((i < nA) && (pB < pBEnd) && (nWinsA < nMinGallop) && (nWinsB < nMinGallop))
+		{
+			if (*pB < pA[i])
+			{
+				*pOut++ = *pB++;
+				lCnt += nA - i;
+				nWinsB++;
+				nWinsA = 0;
+			}
+			else
+			{
+				*pOut++ = pA[i++];
+				nWinsA++;
+				nWinsB = 0;
+			}
+		}
+
+		// take blocks while they are long. the better galloping pays, the sooner it starts next time.
+		while ((i < nA) && (pB < pBEnd))
+		{
+			size_t nBlockA = gallop(*pB, pA + i, nA - i, true);
+			pOut = std::copy(pA + i, pA + i + nBlockA, pOut);
+			i += nBlockA;
+			if (i == nA)
+				break;
+			size_t nBlockB = gallop(pA[i], pB, pBEnd - pB, false);
+			pOut = std::copy(pB, pB + nBlockB, pOut);
+			pB += nBlockB;
+			lCnt += (long long)nBlockB * (nA - i);
+			if ((nBlockA < MIN_GALLOP) && (nBlockB < MIN_GALLOP))
+			{
+				nMinGallop++;
+				break;
+			}
+			if (nMinGallop > 1)
+				nMinGallop--;
+		}
+	}
+	// the rest of the right run is already in place
+	std::copy(pA + i, pA + nA, pOut);
+	return lCnt;
+}
+
+// end of the run of p[0,n) starting at nStart, sorted in place, at least INSERTION_RUN long unless p ends.
+inline size_t natural_run(int* p, size_t nStart, size_t n, long long& lCnt)
+{
+	size_t nEnd = nStart + 1;
+	if (nEnd == n)
+		return nEnd;
+	if (p[nEnd] < p[nStart])
+	{
+		// only a strictly descending run can be reversed without breaking the stability
+		while ((nEnd + 1 < n) && (p[nEnd+1] < p[nEnd]))
+			nEnd++;
+		nEnd++;
+		std::reverse(p + nStart, p + nEnd);
+		lCnt += (long long)(nEnd - nStart) * (nEnd - nStart - 1) / 2;
+	}
+	else
+	{
+		while ((nEnd + 1 < n) && (p[nEnd+1] >= p[nEnd]))
+			nEnd++;
+		nEnd++;
+	}
+	if (nEnd - nStart < INSERTION_RUN)
+	{
+		nEnd = std::min(nStart + INSERTION_RUN, n);
+		lCnt += insertion_sort(p + nStart, nEnd - nStart);
+	}
+	return nEnd;
+}
+
+// powersort priority of the boundary between the adjacent runs [nStart1,nStart2) and [nStart2,nEnd2) of p[0,n):
+// the first bit where the binary fractions midpoint/n of the two runs differ.
+// merging the boundaries of highest power first gives nearly optimal merge trees.
+inline int node_power(size_t nStart1, size_t nStart2, size_t nEnd2, size_t n)
+{
+	// twice the midpoints, in units of 1/(2n)
+	unsigned long long lA = nStart1 + nStart2, lB = nStart2 + nEnd2, lTwoN = 2 * (unsigned long long)n;
+	int nPower = 0;
+	while (true)
+	{
+		nPower++;
+		if (lA >= lTwoN)
+		{
+			lA -= lTwoN;
+			lB -= lTwoN;
+		}
+		else if (lB >= lTwoN)
+			break;
+		lA *= 2;
+		lB *= 2;
+	}
+	return nPower;
+}
+
+// same sorted result and the same number of inversions as recur_mergesort, in near-linear time on input
+// made of a few sorted or reversed runs.
+inline long long adaptive_mergesort(std::vector<int>& vArray)
+{
+	int* p = vArray.data();
+	size_t n = vArray.size();
+	long long lCnt = 0;
+	if (n < 2)
+		return 0;
+	std::vector<int> vBuffer;
+
+	// the runs waiting to be merged, each ending where the next one starts, with the power of their right boundary
+	std::vector<size_t> vStarts;
+	std::vector<int> vPowers;
+	size_t nStartA = 0;
+	size_t nEndA = natural_run(p, 0, n, lCnt);
+	while (nEndA < n)
+	{
+		size_t nEndB = natural_run(p, nEndA, n, lCnt);
+		int nPower = node_power(nStartA, nEndA, nEndB, n);
+		while (!vPowers.empty() && (vPowers.back() > nPower))
+		{
+			lCnt += gallop_merge(p + vStarts.back(), nStartA - vStarts.back(), nEndA - vStarts.back(), vBuffer);
+			nStartA = vStarts.back();
+			vStarts.pop_back();
+			vPowers.pop_back();
+		}
+		vStarts.push_back(nStartA);
+		vPowers.push_back(nPower);
+		nStartA = nEndA;
+		nEndA = nEndB;
+	}
+	while (!vStarts.empty())
+	{
+		lCnt += gallop_merge(p + vStarts.back(), nStartA - vStarts.back(), n - vStarts.back(), vBuffer);
+		nStartA = vStarts.back();
+		vStarts.pop_back();
+	}
+	return lCnt;
+}
+
+const size_t PARALLEL_MIN = (size_t)1 << 16;  // below this length a part is sorted or merged by one thread
+
+// run fTask(0), ..., fTask(nParts-1) on separate threads, the first on the calling thread
+inline void parallel_for(size_t nParts, const std::function<void(size_t)>& fTask)
+{
+	std::vector<std::thread> vThreads;
+	for (size_t t=1; t<nParts; t++)
+		vThreads.emplace_back(fTask, t);
+	fTask(0);
+	for (size_t t=0; t<vThreads.size(); t++)
+		vThreads[t].join();
+}
+
+// number of elements taken from pA[0,nA) among the first nDiag outputs of merging it with pB[0,nB).
+// this is the split point of the merge path on the diagonal nDiag.
+inline size_t co_rank(const int* pA, size_t nA, const int* pB, size_t nB, size_t nDiag)
+{
+	size_t nLo = (nDiag > nB) ? nDiag - nB : 0;
+	size_t nHi = std::min(nDiag, nA);
+	while (nLo < nHi)
+	{
+		size_t nMid = nLo + (nHi - nLo) / 2;
+		// pA[nMid] goes out before pB[nDiag-nMid-1] when it is not greater, as the merge is stable
+		if (pA[nMid] <= pB[nDiag - nMid - 1])
+			nLo = nMid + 1;
+		else
+			nHi = nMid;
+	}
+	return nLo;
+}
+
+// merge the sorted halves p[0,nMiddle) and p[nMiddle,n) back into p, using pBuffer[0,n).
+// the output is cut into nThreads equal pieces along the merge path and each piece is merged by its own thread.
+inline long long parallel_merge(int* p, int* pBuffer, size_t nMiddle, size_t n, size_t nThreads)
+{
+	const int* pA = p;
+	const int* pB = p + nMiddle;
+	size_t nB = n - nMiddle;
+	std::vector<long long> vCnt(nThreads, 0);
+	parallel_for(nThreads, [&](size_t t) {
+		size_t nDiag0 = n * t / nThreads;
+		size_t nDiag1 = n * (t + 1) / nThreads;
+		size_t i = co_rank(pA, nMiddle, pB, nB, nDiag0);
+		vCnt[t] = merge_runs(pA, nMiddle, pB, nB, i, nDiag0 - i, pBuffer + nDiag0, nDiag1 - nDiag0);
+	});
+	parallel_for(nThreads, [&](size_t t) {
+		std::copy(pBuffer + n * t / nThreads, pBuffer + n * (t + 1) / nThreads, p + n * t / nThreads);
+	});
+
+	long long lCnt = 0;
+	for (size_t t=0; t<nThreads; t++)
+		lCnt += vCnt[t];
+	return lCnt;
+}
+
+inline long long recur_parallel_mergesort(int* p, int* pBuffer, size_t n, size_t nThreads)
+{
+	if ((nThreads <= 1) || (n < PARALLEL_MIN))
+	{
+		int* pResult;
+		long long lCnt = bottomup_passes(p, pBuffer, n, pResult);
+		if (pResult != p)
+			std::copy(pResult, pResult + n, p);
+		return lCnt;
+	}
+
+	// the halves are sorted at the same time, each by half of the threads
+	size_t nMiddle = n / 2;
+	size_t nThreads1 = nThreads / 2;
+	long long lCnt1 = 0;
+	std::thread threadLeft([&]() { lCnt1 = recur_parallel_mergesort(p, pBuffer, nMiddle, nThreads1); });
+	long long lCnt = recur_parallel_mergesort(p + nMiddle, pBuffer + nMiddle, n - nMiddle, nThreads - nThreads1);
+	threadLeft.join();
+
+	size_t nMergeThreads = std::max<size_t>(std::min(nThreads, n / PARALLEL_MIN), 1);
+	return lCnt + lCnt1 + parallel_merge(p, pBuffer, nMiddle, n, nMergeThreads);
+}
+
+// multithreaded mergesort with the same sorted result and the same number of inversions as recur_mergesort.
+// nThreads = 0 uses all the cores.
+inline long long parallel_mergesort(std::vector<int>& vArray, size_t nThreads = 0)
+{
+	if (nThreads == 0)
+		nThreads = std::max(std::thread::hardware_concurrency(), 1u);
+	std::vector<int> vBuffer((vArray.size() > INSERTION_RUN) ? vArray.size() : 0);
+	return recur_parallel_mergesort(vArray.data(), vBuffer.data(), vArray.size(), nThreads);
+}
+
+#endif
@@ -9,8 +9,37 @@
 **
 ** Qsort_RangeK sorts only the range [nK1, nK2] of the resulting array. good choice for faster performance when applicable.
 **
+** Select_K, Select_Multi and Select_TopK are selections in linear time (nth_element). the pivot of a large
+** range is found by Floyd-Rivest sampling: the k-th element of a small window around the expected position is
+** selected first, which makes the partition of the whole range land close to k, so a selection takes about
+** N + min(k, N-k) comparisons. when partitions keep missing (adversarial input), the pivots are taken as
+** the median of medians of 5, which guarantees linear time. Qsort_RangeK selects its two ends this way and
+** sorts between them with Qsort_Intro.
 **
-** All compiled and tested with g++ 6.2.0 MinGW-W64
+** Qsort_Intro is the introsort mode, which runs at N*log(N) even in the worst case and uses no random numbers:
+** median-of-3 pivot (ninther for ranges over NINTHER_MIN), insertion sort for ranges under INSERTION_MAX and
+** heapsort when the recursion gets deeper than 2*log2(N). When the pivot equals the element just before the range
+** (which is not greater than anything in it), the range is split 3-way into the run equal to the pivot, which is
+** done, and the greater part, so inputs with many duplicates take linear time per distinct value.
+**
+** Qsort_Block is the same introsort with the BlockQuicksort partition (Edelkamp and Weiss): each side of the
+** range is scanned a block of BLOCK_SIZE elements at a time, the offsets of the misplaced elements are
+** written without branches (the comparison result only advances the write position) and the misplaced elements
+** of both sides are then swapped in one cyclic pass. No branch depends on the data, so random keys do not
+** cause mispredictions.
+**
+** Qsort_Simd is the same introsort with a vectorized partition and a sorting network for ranges of up to
+** SIMD_SMALL elements, chosen at run time from the CPU features:
+**  AVX-512: 16 elements per compare, the two sides compressed into place with masked stores, and a bitonic
+**           network sorting 16 elements in one register.
+**  AVX2   : 8 elements per compare, the two sides packed by a permutation from a 256-entry table and stored
+**           whole at both ends, and the bitonic network over two registers.
+**  neither: falls back to Qsort_Block.
+** The partition keeps one vector from each end in registers, so there is always room for whole-vector
+** stores at both write positions without overwriting unread elements.
+**
+**
+** All compiled and tested with g++ 6.2.0 MinGW-W64 (Qsort_Simd with g++ 12.2.0 on x86-64 Linux)
 **
 ** MIT License 
 ** Copyright (c) 2017 636F57@GitHub 
@@ -20,8 +49,17 @@
 #include <cstdlib> 
 #include <cmath>
 #include <vector>
+#include <utility>
+#include <algorithm>
+#include <climits>
+#include <cstring>
 #include <iostream>
 
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define QSORT_X86_SIMD
+#include <immintrin.h>
+#endif
+
 class QsortCls
 {
 private:
@@ -76,37 +114,792 @@ private:
 		return lCompareCnt;
 	}
 
-	// return values are properly sorted only within the range of [k1, k2] of the sorted array.
-	static void recur_Qsort_K(std::vector<int>& vArray, int nStartIndex, int nEndindex, int nK1, int nK2)
+	static const int INSERTION_MAX = 24;   // ranges shorter than this are insertion-sorted
+	static const int NINTHER_MIN = 128;    // ranges longer than this take the pivot as the median of 3 medians of 3
+
+	static void swapAt(std::vector<int>& vArray, int i, int j)
 	{
-		int nTmp, nPivot = vArray[nStartIndex + floor(rand()*(nEndindex-nStartIndex+1.0)/(RAND_MAX+1.0))];
-		int i= nStartIndex, j = nEndindex;
-		
+		int nTmp = vArray[i];
+		vArray[i] = vArray[j];
+		vArray[j] = nTmp;
+	}
+
+	// order vArray[i] <= vArray[j] <= vArray[k]
+	static void sort3(std::vector<int>& vArray, int i, int j, int k, long long &lCnt)
+	{
+		if (isLess(vArray[j], vArray[i], lCnt))
+			swapAt(vArray, i, j);
+		if (isLess(vArray[k], vArray[j], lCnt))
+		{
+			swapAt(vArray, j, k);
+			if (isLess(vArray[j], vArray[i], lCnt))
+				swapAt(vArray, i, j);
+		}
+	}
+
+	static void insertionSort(std::vector<int>& vArray, int nStartIndex, int nEndindex, long long &lCnt)
+	{
+		for (int i=nStartIndex+1; i<=nEndindex; i++)
+		{
+			int nValue = vArray[i];
+			int j = i;
+			while ((j > nStartIndex) && isLess(nValue, vArray[j-1], lCnt))
+			{
+				vArray[j] = vArray[j-1];
+				j--;
+			}
+			vArray[j] = nValue;
+		}
+	}
+
+	static void siftDown(std::vector<int>& vArray, int nStartIndex, int nRoot, int nSize, long long &lCnt)
+	{
+		int nValue = vArray[nStartIndex + nRoot];
+		int nChild;
+		while ((nChild = 2*nRoot + 1) < nSize)
+		{
+			if ((nChild + 1 < nSize) && isLess(vArray[nStartIndex + nChild], vArray[nStartIndex + nChild + 1], lCnt))
+				nChild++;
+			if (!isLess(nValue, vArray[nStartIndex + nChild], lCnt))
+				break;
+			vArray[nStartIndex + nRoot] = vArray[nStartIndex + nChild];
+			nRoot = nChild;
+		}
+		vArray[nStartIndex + nRoot] = nValue;
+	}
+
+	static void heapSort(std::vector<int>& vArray, int nStartIndex, int nEndindex, long long &lCnt)
+	{
+		int nSize = nEndindex - nStartIndex + 1;
+		for (int i=nSize/2-1; i>=0; i--)
+			siftDown(vArray, nStartIndex, i, nSize, lCnt);
+		for (int i=nSize-1; i>0; i--)
+		{
+			swapAt(vArray, nStartIndex, nStartIndex + i);
+			siftDown(vArray, nStartIndex, 0, i, lCnt);
+		}
+	}
+
+	// move the pivot to vArray[nStartIndex]. an element not less than it is left in the range after it.
+	static void choosePivot(std::vector<int>& vArray, int nStartIndex, int nEndindex, long long &lCnt)
+	{
+		int nSize = nEndindex - nStartIndex + 1;
+		int nMid = nStartIndex + nSize/2;
+		if (nSize > NINTHER_MIN)
+		{
+			sort3(vArray, nStartIndex, nMid, nEndindex, lCnt);
+			sort3(vArray, nStartIndex+1, nMid-1, nEndindex-1, lCnt);
+			sort3(vArray, nStartIndex+2, nMid+1, nEndindex-2, lCnt);
+			sort3(vArray, nMid-1, nMid, nMid+1, lCnt);
+			swapAt(vArray, nStartIndex, nMid);
+		}
+		else
+			sort3(vArray, nMid, nStartIndex, nEndindex, lCnt);
+	}
+
+	// partition around the pivot vArray[nStartIndex] into [< pivot] pivot [>= pivot] and return the pivot index
+	static int partitionRight(std::vector<int>& vArray, int nStartIndex, int nEndindex, long long &lCnt)
+	{
+		int nPivot = vArray[nStartIndex];
+		int i = nStartIndex, j = nEndindex + 1;
+
+		// choosePivot left an element >= pivot to stop this scan
+		while (isLess(vArray[++i], nPivot, lCnt))
+			;
+		// this scan is stopped by the element found above if there is one, otherwise it must be bounded
+		if (i - 1 == nStartIndex)
+		{
+			while ((i < j) && !isLess(vArray[--j], nPivot, lCnt))
+				;
+		}
+		else
+		{
+			while (!isLess(vArray[--j], nPivot, lCnt))
+				;
+		}
+
+		while (i < j)
+		{
+			swapAt(vArray, i, j);
+			while (isLess(vArray[++i], nPivot, lCnt))
+				;
+			while (!isLess(vArray[--j], nPivot, lCnt))
+				;
+		}
+
+		vArray[nStartIndex] = vArray[i-1];
+		vArray[i-1] = nPivot;
+		return i - 1;
+	}
+
+	// partition around the pivot vArray[nStartIndex] into [<= pivot] pivot [> pivot] and return the pivot index
+	static int partitionLeft(std::vector<int>& vArray, int nStartIndex, int nEndindex, long long &lCnt)
+	{
+		int nPivot = vArray[nStartIndex];
+		int i = nStartIndex, j = nEndindex + 1;
+
+		// the pivot itself stops this scan
+		while (isLess(nPivot, vArray[--j], lCnt))
+			;
+		if (j == nEndindex)
+		{
+			while ((i < j) && !isLess(nPivot, vArray[++i], lCnt))
+				;
+		}
+		else
+		{
+			while (!isLess(nPivot, vArray[++i], lCnt))
+				;
+		}
+
+		while (i < j)
+		{
+			swapAt(vArray, i, j);
+			while (isLess(nPivot, vArray[--j], lCnt))
+				;
+			while (!isLess(nPivot, vArray[++i], lCnt))
+				;
+		}
+
+		vArray[nStartIndex] = vArray[j];
+		vArray[j] = nPivot;
+		return j;
+	}
+
+	static const int BLOCK_SIZE = 64;  // elements scanned per block on each side by partitionBlock
+
+	// move the nCount misplaced elements at pLeft+aOffsetsL[i] and pRight-aOffsetsR[i] to the other side.
+	// a cycle with one temporary does one move per element instead of the three of a swap, but it does not keep
+	// the pairs in place, so pairwise swaps are used when both sides are emptied (e.g. on descending input).
+	static void swapOffsets(int* pLeft, int* pRight, const unsigned char* aOffsetsL, const unsigned char* aOffsetsR, int nCount, bool bPairwise)
+	{
+		if (bPairwise)
+		{
+			for (int i=0; i<nCount; i++)
+				std::swap(pLeft[aOffsetsL[i]], *(pRight - aOffsetsR[i]));
+			return;
+		}
+		if (nCount == 0)
+			return;
+		int* pL = pLeft + aOffsetsL[0];
+		int* pR = pRight - aOffsetsR[0];
+		int nTmp = *pL;
+		*pL = *pR;
+		for (int i=1; i<nCount; i++)
+		{
+			pL = pLeft + aOffsetsL[i];
+			*pR = *pL;
+			pR = pRight - aOffsetsR[i];
+			*pL = *pR;
+		}
+		*pR = nTmp;
+	}
+
+	// same result as partitionRight: [< pivot] pivot [>= pivot], but with the block scheme and no data dependent branch
+	static int partitionBlock(std::vector<int>& vArray, int nStartIndex, int nEndindex, long long &lCnt)
+	{
+		int* pBegin = vArray.data() + nStartIndex;
+		int* pFirst = pBegin;
+		int* pLast = vArray.data() + nEndindex + 1;
+		int nPivot = *pBegin;
+
+		// the same bounded scans as partitionRight to find the first pair of misplaced elements
+		while (isLess(*++pFirst, nPivot, lCnt))
+			;
+		if (pFirst - 1 == pBegin)
+		{
+			while ((pFirst < pLast) && !isLess(*--pLast, nPivot, lCnt))
+				;
+		}
+		else
+		{
+			while (!isLess(*--pLast, nPivot, lCnt))
+				;
+		}
+
+		if (pFirst < pLast)
+		{
+			std::swap(*pFirst, *pLast);
+			pFirst++;
+
+			// [pFirst, pLast) is still unknown. the offsets are from pBaseL forward and from pBaseR backward.
+			unsigned char aOffsetsL[BLOCK_SIZE], aOffsetsR[BLOCK_SIZE];
+			int* pBaseL = pFirst;
+			int* pBaseR = pLast;
+			int nNumL = 0, nNumR = 0, nStartL = 0, nStartR = 0;
+			while (pFirst < pLast)
+			{
+				// refill the side(s) with no misplaced element left. split the rest when both sides need it.
+				int nUnknown = pLast - pFirst;
+				int nSplitL = (nNumL == 0) ? ((nNumR == 0) ? nUnknown / 2 : nUnknown) : 0;
+				int nSplitR = (nNumR == 0) ? nUnknown - nSplitL : 0;
+				nSplitL = std::min(nSplitL, (int)BLOCK_SIZE);
+				nSplitR = std::min(nSplitR, (int)BLOCK_SIZE);
+				lCnt += nSplitL + nSplitR;
+
+				for (int i=0; i<nSplitL; i++)
+				{
+					aOffsetsL[nNumL] = i;
+					nNumL += !(*pFirst < nPivot);
+					pFirst++;
+				}
+				for (int i=0; i<nSplitR; )
+				{
+					aOffsetsR[nNumR] = ++i;
+					nNumR += (*--pLast < nPivot);
+				}
+
+				int nCount = std::min(nNumL, nNumR);
+				swapOffsets(pBaseL, pBaseR, aOffsetsL + nStartL, aOffsetsR + nStartR, nCount, nNumL == nNumR);
+				nNumL -= nCount;
+				nNumR -= nCount;
+				nStartL += nCount;
+				nStartR += nCount;
+				if (nNumL == 0)
+				{
+					nStartL = 0;
+					pBaseL = pFirst;
+				}
+				if (nNumR == 0)
+				{
+					nStartR = 0;
+					pBaseR = pLast;
+				}
+			}
+
+			// the misplaced elements left over on one side go next to the boundary, starting from the far ones
+			if (nNumL > 0)
+			{
+				while (nNumL > 0)
+				{
+					nNumL--;
+					std::swap(pBaseL[aOffsetsL[nStartL + nNumL]], *--pLast);
+				}
+				pFirst = pLast;
+			}
+			if (nNumR > 0)
+			{
+				while (nNumR > 0)
+				{
+					nNumR--;
+					std::swap(*(pBaseR - aOffsetsR[nStartR + nNumR]), *pFirst);
+					pFirst++;
+				}
+			}
+		}
+
+		int nPivotIndex = (int)(pFirst - vArray.data()) - 1;
+		vArray[nStartIndex] = vArray[nPivotIndex];
+		vArray[nPivotIndex] = nPivot;
+		return nPivotIndex;
+	}
+
+	enum PartitionMode { PARTITION_HOARE, PARTITION_BLOCK, PARTITION_SIMD };
+	enum SimdLevel { SIMD_NONE, SIMD_AVX2, SIMD_AVX512 };
+
+	static const int SIMD_SMALL = 16;  // ranges up to this length are sorted by the network in PARTITION_SIMD
+
+	// compare-exchange steps of the bitonic network on 16 lanes: block size, partner distance, and the lanes
+	// which take the max of the pair
+	struct BitonicStep
+	{
+		int nBlock;
+		int nDistance;
+		int nMaxLanes;
+	};
+
+	static const BitonicStep* bitonicSteps()
+	{
+		static const BitonicStep aSteps[10] = {
+			{2, 1, 0x6666},
+			{4, 2, 0x3C3C}, {4, 1, 0x5A5A},
+			{8, 4, 0x0FF0}, {8, 2, 0x33CC}, {8, 1, 0x55AA},
+			{16, 8, 0xFF00}, {16, 4, 0xF0F0}, {16, 2, 0xCCCC}, {16, 1, 0xAAAA}};
+		return aSteps;
+	}
+
+	// number of compare-exchanges of the network between two of the first n lanes, i.e. leaving out
+	// the ones against the INT_MAX padding, which compare no elements
+	static int networkCompares(int n)
+	{
+		struct CountTable
+		{
+			int aCount[SIMD_SMALL+1];
+
+			CountTable()
+			{
+				const BitonicStep* aSteps = bitonicSteps();
+				for (int m=0; m<=SIMD_SMALL; m++)
+				{
+					aCount[m] = 0;
+					for (int s=0; s<10; s++)
+					{
+						for (int i=0; i<m; i++)
+						{
+							int j = i ^ aSteps[s].nDistance;
+							if ((i < j) && (j < m))
+								aCount[m]++;
+						}
+					}
+				}
+			}
+		};
+		static const CountTable table;
+		return table.aCount[n];
+	}
+
+	static SimdLevel simdLevel()
+	{
+		static const SimdLevel level = detectSimd();
+		return level;
+	}
+
+	static SimdLevel detectSimd()
+	{
+#ifdef QSORT_X86_SIMD
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512f"))
+			return SIMD_AVX512;
+		if (__builtin_cpu_supports("avx2"))
+			return SIMD_AVX2;
+#endif
+		return SIMD_NONE;
+	}
+
+#ifdef QSORT_X86_SIMD
+	// for each mask of the lanes less than the pivot, the lane order which packs those lanes first
+	struct PermTable
+	{
+		alignas(32) int aIndex[256][8];
+
+		PermTable()
+		{
+			for (int nMask=0; nMask<256; nMask++)
+			{
+				int nLow = 0, nHigh = 7;
+				for (int i=0; i<8; i++)
+				{
+					if (nMask & (1 << i))
+						aIndex[nMask][nLow++] = i;
+				}
+				for (int i=7; i>=0; i--)
+				{
+					if (!(nMask & (1 << i)))
+						aIndex[nMask][nHigh--] = i;
+				}
+			}
+		}
+	};
+
+	static const PermTable& permTable()
+	{
+		static const PermTable table;
+		return table;
+	}
+
+	// pack the lanes of v less than the pivot at pWriteL and the others just before pWriteR.
+	// both stores are whole vectors, so 8 elements must be free at each end.
+	__attribute__((target("avx2")))
+	static void storeAvx2(__m256i v, __m256i vPivot, const PermTable& table, int*& pWriteL, int*& pWriteR)
+	{
+		int nMask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(vPivot, v)));
+		__m256i vPacked = _mm256_permutevar8x32_epi32(v, _mm256_load_si256((const __m256i*)table.aIndex[nMask]));
+		_mm256_storeu_si256((__m256i*)pWriteL, vPacked);
+		_mm256_storeu_si256((__m256i*)(pWriteR - 8), vPacked);
+		int nLess = __builtin_popcount(nMask);
+		pWriteL += nLess;
+		pWriteR -= 8 - nLess;
+	}
+
+	// partition p[0,n) into [< nPivot][>= nPivot] and return the length of the first part. n >= 16.
+	__attribute__((target("avx2")))
+	static int partitionAvx2(int* p, int n, int nPivot)
+	{
+		const PermTable& table = permTable();
+		const __m256i vPivot = _mm256_set1_epi32(nPivot);
+
+		// hold the first and the last vectors aside: this leaves 8 free elements at each end
+		__m256i vFirst = _mm256_loadu_si256((const __m256i*)p);
+		__m256i vLast = _mm256_loadu_si256((const __m256i*)(p + n - 8));
+		int* pReadL = p + 8;
+		int* pReadR = p + n - 8;
+		int* pWriteL = p;
+		int* pWriteR = p + n;
+
+		// read from the side with less free room. the free room of both sides adds up to 16 before each read,
+		// so each has at least 8 after it.
+		while (pReadR - pReadL >= 8)
+		{
+			__m256i v;
+			if (pReadL - pWriteL <= pWriteR - pReadR)
+			{
+				v = _mm256_loadu_si256((const __m256i*)pReadL);
+				pReadL += 8;
+			}
+			else
+			{
+				pReadR -= 8;
+				v = _mm256_loadu_si256((const __m256i*)pReadR);
+			}
+			storeAvx2(v, vPivot, table, pWriteL, pWriteR);
+		}
+
+		// the last few unread elements one by one, then the two held vectors into the 16 free elements left
+		int aRest[8];
+		int nRest = pReadR - pReadL;
+		std::memcpy(aRest, pReadL, nRest * sizeof(int));
+		for (int i=0; i<nRest; i++)
+		{
+			if (aRest[i] < nPivot)
+				*pWriteL++ = aRest[i];
+			else
+				*--pWriteR = aRest[i];
+		}
+		storeAvx2(vFirst, vPivot, table, pWriteL, pWriteR);
+		storeAvx2(vLast, vPivot, table, pWriteL, pWriteR);
+		return pWriteL - p;
+	}
+
+	// sort p[0,n), n <= 16, with the bitonic network over two registers padded with INT_MAX
+	__attribute__((target("avx2")))
+	static void sortSmallAvx2(int* p, int n)
+	{
+		const __m256i vLanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+		const __m256i vLaneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+		const __m256i vMax = _mm256_set1_epi32(INT_MAX);
+		__m256i vLoad0 = _mm256_cmpgt_epi32(_mm256_set1_epi32(n), vLanes);
+		__m256i vLoad1 = _mm256_cmpgt_epi32(_mm256_set1_epi32(n - 8), vLanes);
+		__m256i v0 = _mm256_blendv_epi8(vMax, _mm256_maskload_epi32(p, vLoad0), vLoad0);
+		__m256i v1 = _mm256_blendv_epi8(vMax, _mm256_maskload_epi32(p + 8, vLoad1), vLoad1);
+
+		const BitonicStep* aSteps = bitonicSteps();
+		for (int s=0; s<10; s++)
+		{
+			if (aSteps[s].nDistance == 8)
+			{
+				// the pairs are across the two registers, all ascending
+				__m256i vMin = _mm256_min_epi32(v0, v1);
+				v1 = _mm256_max_epi32(v0, v1);
+				v0 = vMin;
+				continue;
+			}
+			__m256i vPartner = _mm256_xor_si256(vLanes, _mm256_set1_epi32(aSteps[s].nDistance));
+			__m256i vTakeMax0 = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(aSteps[s].nMaxLanes & 0xFF), vLaneBits), vLaneBits);
+			__m256i vTakeMax1 = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(aSteps[s].nMaxLanes >> 8), vLaneBits), vLaneBits);
+			__m256i vOther0 = _mm256_permutevar8x32_epi32(v0, vPartner);
+			__m256i vOther1 = _mm256_permutevar8x32_epi32(v1, vPartner);
+			v0 = _mm256_blendv_epi8(_mm256_min_epi32(v0, vOther0), _mm256_max_epi32(v0, vOther0), vTakeMax0);
+			v1 = _mm256_blendv_epi8(_mm256_min_epi32(v1, vOther1), _mm256_max_epi32(v1, vOther1), vTakeMax1);
+		}
+
+		_mm256_maskstore_epi32(p, vLoad0, v0);
+		_mm256_maskstore_epi32(p + 8, vLoad1, v1);
+	}
+
+	// pack the lanes of v less than the pivot at pWriteL and the others just before pWriteR, with masked stores
+	__attribute__((target("avx512f")))
+	static void storeAvx512(__m512i v, __m512i vPivot, int*& pWriteL, int*& pWriteR)
+	{
+		__mmask16 mLess = _mm512_cmplt_epi32_mask(v, vPivot);
+		int nLess = __builtin_popcount(mLess);
+		int nGreater = 16 - nLess;
+		_mm512_mask_storeu_epi32(pWriteL, (__mmask16)((1u << nLess) - 1), _mm512_maskz_compress_epi32(mLess, v));
+		_mm512_mask_storeu_epi32(pWriteR - nGreater, (__mmask16)((1u << nGreater) - 1), _mm512_maskz_compress_epi32((__mmask16)~mLess, v));
+		pWriteL += nLess;
+		pWriteR -= nGreater;
+	}
+
+	// partition p[0,n) into [< nPivot][>= nPivot] and return the length of the first part. n >= 32.
+	// the same scheme as partitionAvx2 with 16 lanes.
+	__attribute__((target("avx512f")))
+	static int partitionAvx512(int* p, int n, int nPivot)
+	{
+		const __m512i vPivot = _mm512_set1_epi32(nPivot);
+		__m512i vFirst = _mm512_loadu_si512(p);
+		__m512i vLast = _mm512_loadu_si512(p + n - 16);
+		int* pReadL = p + 16;
+		int* pReadR = p + n - 16;
+		int* pWriteL = p;
+		int* pWriteR = p + n;
+
+		while (pReadR - pReadL >= 16)
+		{
+			__m512i v;
+			if (pReadL - pWriteL <= pWriteR - pReadR)
+			{
+				v = _mm512_loadu_si512(pReadL);
+				pReadL += 16;
+			}
+			else
+			{
+				pReadR -= 16;
+				v = _mm512_loadu_si512(pReadR);
+			}
+			storeAvx512(v, vPivot, pWriteL, pWriteR);
+		}
+
+		// the rest is shorter than a vector: store it with masks from both ends
+		int nRest = pReadR - pReadL;
+		__m512i vRest = _mm512_maskz_loadu_epi32((__mmask16)((1u << nRest) - 1), pReadL);
+		__mmask16 mLess = _mm512_mask_cmplt_epi32_mask((__mmask16)((1u << nRest) - 1), vRest, vPivot);
+		__mmask16 mGreater = (__mmask16)(~mLess & ((1u << nRest) - 1));
+		int nLess = __builtin_popcount(mLess);
+		int nGreater = nRest - nLess;
+		_mm512_mask_storeu_epi32(pWriteL, (__mmask16)((1u << nLess) - 1), _mm512_maskz_compress_epi32(mLess, vRest));
+		_mm512_mask_storeu_epi32(pWriteR - nGreater, (__mmask16)((1u << nGreater) - 1), _mm512_maskz_compress_epi32(mGreater, vRest));
+		pWriteL += nLess;
+		pWriteR -= nGreater;
+
+		storeAvx512(vFirst, vPivot, pWriteL, pWriteR);
+		storeAvx512(vLast, vPivot, pWriteL, pWriteR);
+		return pWriteL - p;
+	}
+
+	// sort p[0,n), n <= 16, with the bitonic network in one register padded with INT_MAX
+	__attribute__((target("avx512f")))
+	static void sortSmallAvx512(int* p, int n)
+	{
+		const __m512i vLanes = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+		__mmask16 mLoad = (__mmask16)((1u << n) - 1);
+		__m512i v = _mm512_mask_loadu_epi32(_mm512_set1_epi32(INT_MAX), mLoad, p);
+
+		const BitonicStep* aSteps = bitonicSteps();
+		for (int s=0; s<10; s++)
+		{
+			// the masked forms, as the unmasked ones of g++ 12 trip -Wuninitialized
+			__m512i vOther = _mm512_mask_permutexvar_epi32(v, 0xFFFF, _mm512_xor_si512(vLanes, _mm512_set1_epi32(aSteps[s].nDistance)), v);
+			__m512i vMin = _mm512_mask_min_epi32(v, 0xFFFF, v, vOther);
+			v = _mm512_mask_max_epi32(vMin, (__mmask16)aSteps[s].nMaxLanes, v, vOther);
+		}
+
+		_mm512_mask_storeu_epi32(p, mLoad, v);
+	}
+#endif
+
+	// partitionRight done with vector compares. the ranges too short for the vectors go to partitionBlock.
+	static int partitionSimd(std::vector<int>& vArray, int nStartIndex, int nEndindex, long long &lCnt)
+	{
+		int n = nEndindex - nStartIndex;
+		int nPivot = vArray[nStartIndex];
+		int nLess = -1;
+#ifdef QSORT_X86_SIMD
+		if ((simdLevel() == SIMD_AVX512) && (n >= 32))
+			nLess = partitionAvx512(vArray.data() + nStartIndex + 1, n, nPivot);
+		else if ((simdLevel() != SIMD_NONE) && (n >= 16))
+			nLess = partitionAvx2(vArray.data() + nStartIndex + 1, n, nPivot);
+#endif
+		if (nLess < 0)
+			return partitionBlock(vArray, nStartIndex, nEndindex, lCnt);
+
+		// [nStartIndex+1, nStartIndex+nLess] is less than the pivot. swap the pivot with the last of them.
+		lCnt += n;
+		int nPivotIndex = nStartIndex + nLess;
+		vArray[nStartIndex] = vArray[nPivotIndex];
+		vArray[nPivotIndex] = nPivot;
+		return nPivotIndex;
+	}
+
+	static void sortSmallSimd(std::vector<int>& vArray, int nStartIndex, int nEndindex, long long &lCnt)
+	{
+		int n = nEndindex - nStartIndex + 1;
+#ifdef QSORT_X86_SIMD
+		if (simdLevel() != SIMD_NONE)
+		{
+			lCnt += networkCompares(n);
+			if (simdLevel() == SIMD_AVX512)
+				sortSmallAvx512(vArray.data() + nStartIndex, n);
+			else
+				sortSmallAvx2(vArray.data() + nStartIndex, n);
+			return;
+		}
+#endif
+		insertionSort(vArray, nStartIndex, nEndindex, lCnt);
+	}
+
+	// bLeftmost: true when there is no element before nStartIndex which belongs to a lower partition
+	// nMode: the partition used, see PartitionMode
+	static void recur_Intro(std::vector<int>& vArray, int nStartIndex, int nEndindex, int nDepth, bool bLeftmost, PartitionMode nMode, long long &lCnt)
+	{
+		while (true)
+		{
+			if ((nMode == PARTITION_SIMD) && (nEndindex - nStartIndex + 1 <= SIMD_SMALL))
+			{
+				sortSmallSimd(vArray, nStartIndex, nEndindex, lCnt);
+				return;
+			}
+			if (nEndindex - nStartIndex + 1 < INSERTION_MAX)
+			{
+				insertionSort(vArray, nStartIndex, nEndindex, lCnt);
+				return;
+			}
+			if (nDepth == 0)
+			{
+				heapSort(vArray, nStartIndex, nEndindex, lCnt);
+				return;
+			}
+			nDepth--;
+
+			choosePivot(vArray, nStartIndex, nEndindex, lCnt);
+
+			// the element before the range is <= everything in it. if it equals the pivot, so does the whole
+			// [<= pivot] part, which needs no more sorting.
+			if (!bLeftmost && !isLess(vArray[nStartIndex-1], vArray[nStartIndex], lCnt))
+			{
+				nStartIndex = partitionLeft(vArray, nStartIndex, nEndindex, lCnt) + 1;
+				continue;
+			}
+
+			// recurse into the smaller part and loop on the larger one, so the stack stays within log2(N)
+			int nPivotIndex;
+			if (nMode == PARTITION_SIMD)
+				nPivotIndex = partitionSimd(vArray, nStartIndex, nEndindex, lCnt);
+			else if (nMode == PARTITION_BLOCK)
+				nPivotIndex = partitionBlock(vArray, nStartIndex, nEndindex, lCnt);
+			else
+				nPivotIndex = partitionRight(vArray, nStartIndex, nEndindex, lCnt);
+			if (nPivotIndex - nStartIndex < nEndindex - nPivotIndex)
+			{
+				recur_Intro(vArray, nStartIndex, nPivotIndex-1, nDepth, bLeftmost, nMode, lCnt);
+				nStartIndex = nPivotIndex + 1;
+				bLeftmost = false;
+			}
+			else
+			{
+				recur_Intro(vArray, nPivotIndex+1, nEndindex, nDepth, false, nMode, lCnt);
+				nEndindex = nPivotIndex - 1;
+			}
+		}
+	}
+
+	// introsort of [nStartIndex, nEndindex]. bLeftmost as in recur_Intro.
+	static long long introsort(std::vector<int>& vArray, int nStartIndex, int nEndindex, bool bLeftmost, PartitionMode nMode)
+	{
+		if ((nMode == PARTITION_SIMD) && (simdLevel() == SIMD_NONE))
+			nMode = PARTITION_BLOCK;
+		long long lCompareCnt = 0;
+		int nDepth = 0;
+		for (int n=nEndindex-nStartIndex+1; n>1; n/=2)
+			nDepth += 2;
+		recur_Intro(vArray, nStartIndex, nEndindex, nDepth, bLeftmost, nMode, lCompareCnt);
+		return lCompareCnt;
+	}
+
+	static long long introsort(std::vector<int>& vArray, PartitionMode nMode)
+	{
+		return introsort(vArray, 0, (int)vArray.size()-1, true, nMode);
+	}
+
+	static const int SELECT_SMALL = 16;        // ranges up to this length are insertion-sorted by the selection
+	static const int FLOYD_RIVEST_MIN = 600;   // ranges longer than this take the pivot from a sample
+
+	// Hoare partition of [nStartIndex, nEndindex] around nPivot, which must be one of its elements.
+	// afterwards [nStartIndex, j] <= nPivot, [i, nEndindex] >= nPivot and everything between is nPivot.
+	// equal elements stop both scans, so they end up on both sides and many duplicates still split evenly.
+	static void partitionValue(std::vector<int>& vArray, int nStartIndex, int nEndindex, int nPivot, int& i, int& j)
+	{
+		i = nStartIndex;
+		j = nEndindex;
 		do
 		{
-			while ( vArray[i] < nPivot )
+			while (vArray[i] < nPivot)
 				i++;
-			while ( nPivot < vArray[j] )
+			while (nPivot < vArray[j])
 				j--;
-			
 			if (i <= j)
 			{
-				nTmp = vArray[i];
-				vArray[i] = vArray[j];
-				vArray[j] = nTmp;
+				swapAt(vArray, i, j);
 				i++;
 				j--;
 			}
-		} while(i<=j);
-		
-		if ((nStartIndex < j) && (j >= nK1))
-			recur_Qsort_K(vArray, nStartIndex, j, nK1, nK2);
-		if ((i < nEndindex) && (i <= nK2))
-			recur_Qsort_K(vArray, i, nEndindex, nK1, nK2);
+		} while (i <= j);
+	}
 
-		return;
+	// the median of the medians of groups of 5, found with the guaranteed selection. linear in the worst case.
+	static int medianOfMedians(std::vector<int>& vArray, int nStartIndex, int nEndindex)
+	{
+		long long lCnt = 0;
+		int nMedians = 0;
+		for (int i=nStartIndex; i+4<=nEndindex; i+=5)
+		{
+			insertionSort(vArray, i, i+4, lCnt);
+			swapAt(vArray, nStartIndex + nMedians, i + 2);
+			nMedians++;
+		}
+		int nMid = nStartIndex + nMedians/2;
+		recur_Select(vArray, nStartIndex, nStartIndex + nMedians - 1, nMid, true);
+		return vArray[nMid];
 	}
 
+	// put the nK-th element in place: [nStartIndex, nK) <= vArray[nK] <= (nK, nEndindex].
+	// bGuaranteed: take every pivot by medianOfMedians.
+	static void recur_Select(std::vector<int>& vArray, int nStartIndex, int nEndindex, int nK, bool bGuaranteed)
+	{
+		// a partition which keeps more than 3/4 of the range is a miss. after log2(N) misses, the pivots are
+		// taken by medianOfMedians.
+		int nMisses = 0;
+		for (int n=nEndindex-nStartIndex+1; n>1; n/=2)
+			nMisses++;
+
+		while (nEndindex - nStartIndex + 1 > SELECT_SMALL)
+		{
+			int nSize = nEndindex - nStartIndex + 1;
+			int nPivot;
+			if (bGuaranteed)
+				nPivot = medianOfMedians(vArray, nStartIndex, nEndindex);
+			else if (nSize > FLOYD_RIVEST_MIN)
+			{
+				// select nK within a window of about N^(2/3) elements placed where the k-th would be expected
+				double dN = nSize;
+				double dI = nK - nStartIndex + 1;
+				double dZ = log(dN);
+				double dS = 0.5 * exp(2*dZ/3);
+				double dSD = 0.5 * sqrt(dZ*dS*(dN - dS)/dN) * ((dI < dN/2) ? -1 : 1);
+				int nLo = std::max(nStartIndex, (int)floor(nK - dI*dS/dN + dSD));
+				int nHi = std::min(nEndindex, (int)floor(nK + (dN - dI)*dS/dN + dSD));
+				recur_Select(vArray, nLo, nHi, nK, false);
+				nPivot = vArray[nK];
+			}
+			else
+			{
+				long long lCnt = 0;
+				int nMid = nStartIndex + nSize/2;
+				sort3(vArray, nStartIndex, nMid, nEndindex, lCnt);
+				nPivot = vArray[nMid];
+			}
+
+			int i, j;
+			partitionValue(vArray, nStartIndex, nEndindex, nPivot, i, j);
+			if (nK <= j)
+				nEndindex = j;
+			else if (nK >= i)
+				nStartIndex = i;
+			else
+				return;  // nK is among the elements equal to the pivot
+
+			if ((nEndindex - nStartIndex + 1 > nSize / 4 * 3) && (--nMisses <= 0))
+				bGuaranteed = true;
+		}
+		long long lCnt = 0;
+		insertionSort(vArray, nStartIndex, nEndindex, lCnt);
+	}
+
+	// put every vKs[nFirst, nLast) in place, the ks sorted and within [nStartIndex, nEndindex]
+	static void recur_SelectMulti(std::vector<int>& vArray, int nStartIndex, int nEndindex, const std::vector<int>& vKs, size_t nFirst, size_t nLast)
+	{
+		if (nFirst >= nLast)
+			return;
+		// the middle k splits the range and the ks in two halves
+		size_t nMid = nFirst + (nLast - nFirst)/2;
+		int nK = vKs[nMid];
+		recur_Select(vArray, nStartIndex, nEndindex, nK, false);
+		size_t nLeftLast = nMid, nRightFirst = nMid + 1;
+		while ((nLeftLast > nFirst) && (vKs[nLeftLast-1] == nK))
+			nLeftLast--;
+		while ((nRightFirst < nLast) && (vKs[nRightFirst] == nK))
+			nRightFirst++;
+		recur_SelectMulti(vArray, nStartIndex, nK-1, vKs, nFirst, nLeftLast);
+		recur_SelectMulti(vArray, nK+1, nEndindex, vKs, nRightFirst, nLast);
+	}
 
 public:
 	QsortCls(){}
@@ -124,10 +917,58 @@ public:
 		return recur_Qsort(vArray, 0, vArray.size()-1, true);
 	}
 
+	// Introsort: deterministic median-of-3 / ninther pivot, N*log(N) in the worst case
+	static long long Qsort_Intro(std::vector<int>& vArray)
+	{
+		return introsort(vArray, PARTITION_HOARE);
+	}
+
+	// Introsort with the branchless block partition. faster on random keys.
+	static long long Qsort_Block(std::vector<int>& vArray)
+	{
+		return introsort(vArray, PARTITION_BLOCK);
+	}
+
+	// Introsort with the AVX2 / AVX-512 partition and small sort when the CPU has them, Qsort_Block otherwise.
+	// a vector partition counts one comparison per element and the network its compare-exchanges between elements.
+	static long long Qsort_Simd(std::vector<int>& vArray)
+	{
+		return introsort(vArray, PARTITION_SIMD);
+	}
+
 	// Quick-sort only the interested range [nK1, nK2] of the resulting array
 	static void Qsort_RangeK(std::vector<int>& vArray, int nK1, int nK2)
 	{
-		return recur_Qsort_K(vArray, 0, vArray.size()-1, nK1, nK2);
+		int nLast = (int)vArray.size() - 1;
+		nK1 = std::max(nK1, 0);
+		nK2 = std::min(nK2, nLast);
+		if (nK1 > nK2)
+			return;
+		recur_Select(vArray, 0, nLast, nK1, false);
+		recur_Select(vArray, nK1, nLast, nK2, false);
+		introsort(vArray, nK1+1, nK2-1, false, PARTITION_HOARE);
+	}
+
+	// put the nK-th smallest element (from 0) at vArray[nK], the smaller ones before it and the greater after it
+	static void Select_K(std::vector<int>& vArray, int nK)
+	{
+		if ((nK >= 0) && (nK < (int)vArray.size()))
+			recur_Select(vArray, 0, vArray.size()-1, nK, false);
+	}
+
+	// Select_K for all the ranks in vKs at once, e.g. the percentiles. each range is partitioned only once
+	// for all the ks in it.
+	static void Select_Multi(std::vector<int>& vArray, std::vector<int> vKs)
+	{
+		vKs.erase(std::remove_if(vKs.begin(), vKs.end(), [&](int nK) { return (nK < 0) || (nK >= (int)vArray.size()); }), vKs.end());
+		std::sort(vKs.begin(), vKs.end());
+		recur_SelectMulti(vArray, 0, vArray.size()-1, vKs, 0, vKs.size());
+	}
+
+	// the nK smallest elements sorted at the front of the array, the rest after them in no order
+	static void Select_TopK(std::vector<int>& vArray, int nK)
+	{
+		Qsort_RangeK(vArray, 0, nK-1);
 	}
 	
 	// Produce the worst case permutation for the middle pivot quicksort
@@ -198,17 +1039,20 @@ int main()
 		}
 		std::cout << "\n";
 	*/	
+		std::vector<int> vArray3 = vArray2;
 		long long lCntM = QsortCls::Qsort_Middle(vArray1); //std::cout << "\n";
 		long long lCntR = QsortCls::Qsort(vArray2);
+		long long lCntI = QsortCls::Qsort_Intro(vArray3);
 		
-		std::cout << "The number of comparison needed to sort the seaquence : \n Middle-pivot = " << std::to_string(lCntM) << ", Random-pivot = " << std::to_string(lCntR) << ".\n";
+		std::cout << "The number of comparison needed to sort the seaquence : \n Middle-pivot = " << std::to_string(lCntM) << ", Random-pivot = " << std::to_string(lCntR) << ", Introsort = " << std::to_string(lCntI) << ".\n";
 		
 		std::cout << "\nDemonstration of sorting a sorted seaquence.\n";
 		
 		lCntM = QsortCls::Qsort_Middle(vArray1);
 		lCntR = QsortCls::Qsort(vArray2);
+		lCntI = QsortCls::Qsort_Intro(vArray3);
 		
-		std::cout << "The number of comparison needed to sort the seaquence : \n Middle-pivot = " << std::to_string(lCntM) << ", Random-pivot = " << std::to_string(lCntR) << ".\n";
+		std::cout << "The number of comparison needed to sort the seaquence : \n Middle-pivot = " << std::to_string(lCntM) << ", Random-pivot = " << std::to_string(lCntR) << ", Introsort = " << std::to_string(lCntI) << ".\n";
 	}
 	
 	return 0;
@@ -0,0 +1,287 @@
+/* radixsort.cpp
+**
+** Radix-sort library for integer keys (signed or unsigned, 8 to 64 bits). runs at N*(key bits / digit bits).
+**
+** LSD_Sort is the least-significant-digit-first sort. stable, one buffer of the array size.
+**  the histograms of all the digits are counted in a single read of the array, and a pass is skipped when
+**  all the keys share its digit (e.g. the high digits of small values).
+** MSD_Sort is the most-significant-digit-first sort, in place (American flag sort). unstable, which does not
+**  matter for plain keys. levels where all the keys of a bucket share the digit are skipped, and buckets shorter
+**  than MSD_SMALL are insertion-sorted, so it does well on skewed data where most keys fall in a few buckets.
+**
+** nDigitBits is 8, 11 or 16 (11 is usually the fastest for LSD, 8 for MSD, whose in-place moves between
+** many buckets miss the cache). signed keys are ordered by flipping their sign bit before taking the digits.
+** nThreads > 1 splits the counts and the scatter of each LSD pass into contiguous parts, one per thread,
+** with each part writing to its own offsets so the result is the same; MSD sorts the top-level buckets over the
+** threads. nThreads = 0 uses all the cores.
+**
+** compiled and tested with g++ 12.2.0 (compile with -pthread)
+**
+** MIT License
+** Copyright (c) 2017 636F57@GitHub
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE
+*/
+
+#include <cstdlib>
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <functional>
+#include <stdexcept>
+#include <type_traits>
+#include <iostream>
+
+class RadixSortCls
+{
+private:
+	static const size_t PARALLEL_MIN = (size_t)1 << 16;  // elements per thread below which fewer threads are used
+	static const size_t MSD_SMALL = 32;                  // buckets shorter than this are insertion-sorted by MSD
+
+	// the key as an unsigned number in the same order as the value
+	template<typename T>
+	static typename std::make_unsigned<T>::type toKey(T nValue)
+	{
+		typedef typename std::make_unsigned<T>::type U;
+		U nKey = (U)nValue;
+		if (std::is_signed<T>::value)
+			nKey ^= (U)1 << (sizeof(T)*8 - 1);
+		return nKey;
+	}
+
+	template<typename T>
+	static size_t digit(T nValue, int nShift, size_t nMask)
+	{
+		return (size_t)(toKey(nValue) >> nShift) & nMask;
+	}
+
+	static void checkDigitBits(int nDigitBits)
+	{
+		if ((nDigitBits != 8) && (nDigitBits != 11) && (nDigitBits != 16))
+			throw std::invalid_argument("RadixSortCls: nDigitBits must be 8, 11 or 16");
+	}
+
+	static size_t threadCount(int nThreads, size_t n)
+	{
+		size_t nCount = (nThreads > 0) ? nThreads : std::max(std::thread::hardware_concurrency(), 1u);
+		return std::max<size_t>(std::min(nCount, n / PARALLEL_MIN), 1);
+	}
+
+	// run fTask(0), ..., fTask(nParts-1) on separate threads, the first on the calling thread
+	static void parallelFor(size_t nParts, const std::function<void(size_t)>& fTask)
+	{
+		std::vector<std::thread> vThreads;
+		for (size_t t=1; t<nParts; t++)
+			vThreads.emplace_back(fTask, t);
+		fTask(0);
+		for (size_t t=0; t<vThreads.size(); t++)
+			vThreads[t].join();
+	}
+
+	template<typename T>
+	static void insertionSort(T* p, size_t n)
+	{
+		for (size_t i=1; i<n; i++)
+		{
+			T nValue = p[i];
+			size_t j = i;
+			while ((j > 0) && (nValue < p[j-1]))
+			{
+				p[j] = p[j-1];
+				j--;
+			}
+			p[j] = nValue;
+		}
+	}
+
+	// sort p[0,n) by the key bits below nTop. the bits above are the same for all of p.
+	// buckets with fewer elements than digit values are split by 8-bit digits, as counting would cost more.
+	template<typename T>
+	static void recur_MSD(T* p, size_t n, int nTop, int nDigitBits, size_t nThreads)
+	{
+		if (n < MSD_SMALL)
+		{
+			insertionSort(p, n);
+			return;
+		}
+		if (n < ((size_t)1 << nDigitBits))
+			nDigitBits = 8;
+		const size_t nBuckets = (size_t)1 << nDigitBits;
+		const size_t nMask = nBuckets - 1;
+		int nShift = std::max(nTop - nDigitBits, 0);
+		std::vector<size_t> vCount(nBuckets);
+		while (true)
+		{
+			std::fill(vCount.begin(), vCount.end(), 0);
+			for (size_t i=0; i<n; i++)
+				vCount[digit(p[i], nShift, nMask)]++;
+			// the lowest digit may overlap the one above it (e.g. 11-bit digits of 32-bit keys), which is harmless
+			if (vCount[digit(p[0], nShift, nMask)] < n)
+				break;
+			if (nShift == 0)
+				return;
+			nShift = std::max(nShift - nDigitBits, 0);
+		}
+
+		// move every element into its bucket, following the cycles of the permutation
+		std::vector<size_t> vStart(nBuckets + 1), vNext(nBuckets);
+		vStart[0] = 0;
+		for (size_t b=0; b<nBuckets; b++)
+		{
+			vStart[b+1] = vStart[b] + vCount[b];
+			vNext[b] = vStart[b];
+		}
+		for (size_t b=0; b<nBuckets; b++)
+		{
+			while (vNext[b] < vStart[b+1])
+			{
+				T nValue = p[vNext[b]];
+				size_t d = digit(nValue, nShift, nMask);
+				while (d != b)
+				{
+					std::swap(nValue, p[vNext[d]++]);
+					d = digit(nValue, nShift, nMask);
+				}
+				p[vNext[b]++] = nValue;
+			}
+		}
+		if (nShift == 0)
+			return;
+
+		if (nThreads <= 1)
+		{
+			for (size_t b=0; b<nBuckets; b++)
+				recur_MSD(p + vStart[b], vCount[b], nShift, nDigitBits, 1);
+			return;
+		}
+
+		// each thread takes the next bucket left until all are done
+		std::atomic<size_t> nNextBucket(0);
+		parallelFor(nThreads, [&](size_t) {
+			size_t b;
+			while ((b = nNextBucket++) < nBuckets)
+				recur_MSD(p + vStart[b], vCount[b], nShift, nDigitBits, 1);
+		});
+	}
+
+public:
+	RadixSortCls(){}
+	~RadixSortCls(){}
+
+	// stable least-significant-digit-first radix sort
+	template<typename T>
+	static void LSD_Sort(std::vector<T>& vArray, int nDigitBits = 8, int nThreads = 1)
+	{
+		static_assert(std::is_integral<T>::value, "RadixSortCls sorts integer keys");
+		checkDigitBits(nDigitBits);
+		const size_t n = vArray.size();
+		if (n < 2)
+			return;
+		const int nPasses = (sizeof(T)*8 + nDigitBits - 1) / nDigitBits;
+		const size_t nBuckets = (size_t)1 << nDigitBits;
+		const size_t nMask = nBuckets - 1;
+		const size_t nParts = threadCount(nThreads, n);
+
+		// vPartCount[t][pass*nBuckets + digit] counts the part t of the array.
+		// summed over the parts, it tells which passes can be skipped.
+		std::vector<std::vector<size_t>> vPartCount(nParts, std::vector<size_t>(nPasses * nBuckets, 0));
+		parallelFor(nParts, [&](size_t t) {
+			size_t* pCount = vPartCount[t].data();
+			for (size_t i=n*t/nParts; i<n*(t+1)/nParts; i++)
+			{
+				for (int nPass=0; nPass<nPasses; nPass++)
+					pCount[nPass*nBuckets + digit(vArray[i], nPass*nDigitBits, nMask)]++;
+			}
+		});
+
+		std::vector<T> vBuffer(n);
+		T* pSrc = vArray.data();
+		T* pDst = vBuffer.data();
+		bool bMoved = false;
+		std::vector<std::vector<size_t>> vOffset(nParts, std::vector<size_t>(nBuckets));
+		for (int nPass=0; nPass<nPasses; nPass++)
+		{
+			int nShift = nPass * nDigitBits;
+			size_t nFirst = digit(pSrc[0], nShift, nMask);
+			size_t nSame = 0;
+			for (size_t t=0; t<nParts; t++)
+				nSame += vPartCount[t][nPass*nBuckets + nFirst];
+			if (nSame == n)
+				continue;
+
+			// the parts have been rearranged by the previous passes, so their counts are taken again
+			if (bMoved && (nParts > 1))
+			{
+				parallelFor(nParts, [&](size_t t) {
+					size_t* pCount = vPartCount[t].data() + nPass*nBuckets;
+					std::fill(pCount, pCount + nBuckets, 0);
+					for (size_t i=n*t/nParts; i<n*(t+1)/nParts; i++)
+						pCount[digit(pSrc[i], nShift, nMask)]++;
+				});
+			}
+
+			// bucket b of part t starts after the smaller buckets of all the parts and bucket b of the parts before t
+			size_t nPos = 0;
+			for (size_t b=0; b<nBuckets; b++)
+			{
+				for (size_t t=0; t<nParts; t++)
+				{
+					vOffset[t][b] = nPos;
+					nPos += vPartCount[t][nPass*nBuckets + b];
+				}
+			}
+
+			parallelFor(nParts, [&](size_t t) {
+				size_t* pOffset = vOffset[t].data();
+				for (size_t i=n*t/nParts; i<n*(t+1)/nParts; i++)
+					pDst[pOffset[digit(pSrc[i], nShift, nMask)]++] = pSrc[i];
+			});
+			std::swap(pSrc, pDst);
+			bMoved = true;
+		}
+
+		// after an odd number of passes the result is in the buffer
+		if (pSrc != vArray.data())
+			vArray.swap(vBuffer);
+	}
+
+	// in-place most-significant-digit-first radix sort
+	template<typename T>
+	static void MSD_Sort(std::vector<T>& vArray, int nDigitBits = 8, int nThreads = 1)
+	{
+		static_assert(std::is_integral<T>::value, "RadixSortCls sorts integer keys");
+		checkDigitBits(nDigitBits);
+		recur_MSD(vArray.data(), vArray.size(), (int)sizeof(T)*8, nDigitBits, threadCount(nThreads, vArray.size()));
+	}
+};
+
+int main()
+{
+	std::string strN;
+
+	std::cout << "Enter the length of the integer sequence." << std::endl;
+	std::cin >> strN;
+	long long lTotal = std::stoll(strN);
+
+	std::cout << "Enter the integer seaquence separating each numbers with a space." << std::endl;
+
+	std::vector<int> vArray;
+	for (long long i=0; i<lTotal; i++)
+	{
+		std::cin >> strN;
+		vArray.push_back(std::stoi(strN));
+	}
+
+	RadixSortCls::LSD_Sort(vArray, 8, 0);
+
+	std::cout << "The sorted seaquence : \n";
+	for (long long i=0; i<lTotal; i++)
+	{
+		std::cout << std::to_string(vArray[i]) << " ";
+	}
+	std::cout << "\n";
+
+	return 0;
+}
@@ -0,0 +1,60 @@
+/* topk.cpp
+**
+** Shows the k smallest and the k largest integers of a sequence of any length given on the standard input
+** (until its end), with the streaming top-k in topk.h. only O(k) values are kept in memory.
+**
+** compiled and tested with g++ 12.2.0
+**
+** MIT License
+** Copyright (c) 2017 636F57@GitHub
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE
+*/
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <iostream>
+#include "topk.h"
+
+int main()
+{
+	std::string strN;
+
+	std::cout << "Enter k." << std::endl;
+	std::cin >> strN;
+	size_t nK = std::stoull(strN);
+
+	std::cout << "Enter the integer seaquence separating each numbers with a space, and end it with EOF." << std::endl;
+
+	TopK<int> smallest(nK);
+	TopK<int, std::greater<int>> largest(nK);
+	const size_t BATCH = 4096;
+	std::vector<int> vBatch;
+	vBatch.reserve(BATCH);
+	while (std::cin >> strN)
+	{
+		vBatch.push_back(std::stoi(strN));
+		if (vBatch.size() == BATCH)
+		{
+			smallest.push(vBatch.data(), vBatch.size());
+			largest.push(vBatch.data(), vBatch.size());
+			vBatch.clear();
+		}
+	}
+	smallest.push(vBatch.data(), vBatch.size());
+	largest.push(vBatch.data(), vBatch.size());
+
+	std::vector<int> vSmallest = smallest.result();
+	std::cout << "The " << vSmallest.size() << " smallest : \n";
+	for (size_t i=0; i<vSmallest.size(); i++)
+		std::cout << std::to_string(vSmallest[i]) << " ";
+	std::cout << "\n";
+
+	std::vector<int> vLargest = largest.result();
+	std::cout << "The " << vLargest.size() << " largest : \n";
+	for (size_t i=0; i<vLargest.size(); i++)
+		std::cout << std::to_string(vLargest[i]) << " ";
+	std::cout << "\n";
+
+	return 0;
+}
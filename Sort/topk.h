@@ -0,0 +1,127 @@
+/* topk.h
+**
+** Streaming top-k: the k smallest (or, with std::greater, the k largest) values of a stream of any length,
+** in O(k) memory.
+**
+** The values are collected in a buffer of 2k. When it is full, nth_element keeps the k best and the k-th best
+** becomes the threshold: later values which are not better than it are dropped with a single comparison, so
+** on a long stream almost every value costs one comparison, and the selections, linear in k, happen at most
+** once every k accepted values.
+** push(p, n) takes a batch at a time, which keeps the filter loop tight.
+** Each thread can feed its own TopK and the partial results are combined with merge(), which gives the same
+** values as a single TopK fed with all the streams.
+**
+** compiled and tested with g++ 12.2.0
+**
+** MIT License
+** Copyright (c) 2017 636F57@GitHub
+** See more detail at https://github.com/636F57/Algos/blob/master/LICENSE
+*/
+
+#ifndef TOPK_H
+#define TOPK_H
+
+#include <cstdlib>
+#include <vector>
+#include <algorithm>
+#include <functional>
+
+template<typename T = int, typename Compare = std::less<T>>
+class TopK
+{
+private:
+	size_t nK;
+	Compare comp;
+	std::vector<T> vBuffer;  // the k best so far and the accepted values after them, at most 2k
+	bool bThreshold;         // true once k values have been kept, after which nThreshold is the k-th best
+	T nThreshold;
+
+	// keep the k best values of the buffer
+	void shrink()
+	{
+		std::nth_element(vBuffer.begin(), vBuffer.begin() + (nK - 1), vBuffer.end(), comp);
+		vBuffer.resize(nK);
+		nThreshold = vBuffer[nK - 1];
+		bThreshold = true;
+	}
+
+public:
+	explicit TopK(size_t k, Compare c = Compare()) : nK(k), comp(c), bThreshold(false), nThreshold()
+	{
+		vBuffer.reserve(2 * nK);
+	}
+
+	size_t k() const
+	{
+		return nK;
+	}
+
+	void push(const T& nValue)
+	{
+		if ((nK == 0) || (bThreshold && !comp(nValue, nThreshold)))
+			return;
+		vBuffer.push_back(nValue);
+		if (vBuffer.size() == 2 * nK)
+			shrink();
+	}
+
+	// push p[0,n)
+	void push(const T* p, size_t n)
+	{
+		if (nK == 0)
+			return;
+		size_t i = 0;
+		// until the buffer holds k values, everything is accepted
+		while ((i < n) && !bThreshold)
+			push(p[i++]);
+		while (i < n)
+		{
+			// the filter cannot change before the buffer is full again
+			size_t nRoom = 2 * nK - vBuffer.size();
+			for (; (i < n) && (nRoom > 0); i++)
+			{
+				if (comp(p[i], nThreshold))
+				{
+					vBuffer.push_back(p[i]);
+					nRoom--;
+				}
+			}
+			if (nRoom == 0)
+				shrink();
+		}
+	}
+
+	// add the values kept by another TopK with the same k and order, e.g. the one of another thread
+	void merge(const TopK& other)
+	{
+		if (&other == this)
+		{
+			// push() may reallocate or shrink the buffer it would be reading from
+			std::vector<T> vCopy(vBuffer);
+			push(vCopy.data(), vCopy.size());
+			return;
+		}
+		push(other.vBuffer.data(), other.vBuffer.size());
+	}
+
+	// the best min(k, number of values pushed) values, best first
+	std::vector<T> result() const
+	{
+		std::vector<T> vResult(vBuffer);
+		if (vResult.size() > nK)
+		{
+			std::nth_element(vResult.begin(), vResult.begin() + (nK - 1), vResult.end(), comp);
+			vResult.resize(nK);
+		}
+		std::sort(vResult.begin(), vResult.end(), comp);
+		return vResult;
+	}
+
+	void clear()
+	{
+		vBuffer.clear();
+		bThreshold = false;
+	}
+};
+
+#endif